@@ -0,0 +1,157 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "agent.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* Idle passes over all channels before the host starts sleeping between polls */
+#define AGENT_SPIN_LIMIT 4096
+#define AGENT_IDLE_SLEEP_NS 50000L
+
+/* Per-game counters carried into every observation */
+typedef struct {
+    uint64_t step;
+    uint32_t rejected;
+} AgentGame;
+
+static void observe(Termv *t, const AgentGame *game, AgentObservation *o) {
+    TermvPiece p;
+    TermvTimers tm;
+    unsigned short rows[TERMV_BOARD_HEIGHT];
+
+    termv_board_bits(t, rows);
+    termv_current(t, &p);
+    termv_timers(t, &tm);
+
+    memset(o, 0, sizeof(*o));
+    o->step = game->step;
+    o->rejected = game->rejected;
+    for (int r = 0; r < TERMV_BOARD_HEIGHT; r++)
+        o->rows[r] = rows[r];
+    o->piece_row = (int16_t)p.row;
+    o->piece_col = (int16_t)p.col;
+    o->piece_type = (uint8_t)p.type;
+    o->piece_rotation = (uint8_t)p.rotation;
+    o->next_type = (uint8_t)termv_next(t);
+    o->state = (uint8_t)termv_state(t);
+    o->score = (uint32_t)termv_score(t);
+    o->lines = (uint32_t)termv_lines(t);
+    o->level = (uint32_t)termv_level(t);
+    o->locking = (uint8_t)tm.locking;
+    o->gravity_interval = (float)tm.gravity_interval;
+    o->gravity_timer = (float)tm.gravity_timer;
+    o->lock_timer = (float)tm.lock_timer;
+}
+
+/* Serve one pending action on a channel. Returns 1 if any work was done. */
+static int serve(AgentChannel *ch, Termv *t, AgentGame *game) {
+    AgentObservation obs;
+    AgentAction a;
+
+    /* Only take an action when its observation is guaranteed a slot */
+    AgentObservationRing *out = &ch->observations;
+    if (out->head - __atomic_load_n(&out->tail, __ATOMIC_ACQUIRE) == AGENT_RING_SIZE)
+        return 0;
+    if (!agent_pop_action(&ch->actions, &a))
+        return 0;
+
+    if (a.action > TERMV_ACTION_PAUSE) {
+        game->rejected++;
+    } else {
+        if (a.flags & AGENT_FLAG_RESET) {
+            termv_reset(t, a.seed);
+            game->step = 0;
+        }
+        termv_apply(t, (TermvAction)a.action);
+        if (a.ticks > 0)
+            termv_step(t, a.ticks);
+        game->step++;
+    }
+
+    observe(t, game, &obs);
+    agent_push_observation(out, &obs);
+    return 1;
+}
+
+int agent_run(const char *path, unsigned int games, unsigned int seed) {
+    if (games == 0 || games > AGENT_MAX_GAMES) {
+        fprintf(stderr, "termv: agent games must be 1-%d\n", AGENT_MAX_GAMES);
+        return 1;
+    }
+
+    size_t size = agent_segment_size(games);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0 || ftruncate(fd, (off_t)size) != 0) {
+        perror(path);
+        if (fd >= 0)
+            close(fd);
+        return 1;
+    }
+    void *seg = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (seg == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    Termv **handles = calloc(games, sizeof(*handles));
+    AgentGame *state = calloc(games, sizeof(*state));
+    if (!handles || !state) {
+        fprintf(stderr, "termv: out of memory\n");
+        munmap(seg, size);
+        return 1;
+    }
+
+    /* Initial observations, then announce the segment */
+    for (unsigned int i = 0; i < games; i++) {
+        AgentObservation obs;
+        handles[i] = termv_create(seed + i);
+        if (!handles[i]) {
+            fprintf(stderr, "termv: out of memory\n");
+            return 1;
+        }
+        observe(handles[i], &state[i], &obs);
+        agent_push_observation(&agent_channel(seg, i)->observations, &obs);
+    }
+
+    AgentHeader *hdr = seg;
+    hdr->magic = AGENT_MAGIC;
+    hdr->version = AGENT_VERSION;
+    hdr->games = games;
+    hdr->ring_size = AGENT_RING_SIZE;
+    __atomic_store_n(&hdr->ready, 1, __ATOMIC_RELEASE);
+
+    /* Busy-poll while there is traffic; back off to short sleeps when idle */
+    int idle = 0;
+    while (!__atomic_load_n(&hdr->shutdown, __ATOMIC_ACQUIRE)) {
+        int busy = 0;
+        for (unsigned int i = 0; i < games; i++)
+            busy |= serve(agent_channel(seg, i), handles[i], &state[i]);
+
+        if (busy) {
+            idle = 0;
+        } else if (++idle > AGENT_SPIN_LIMIT) {
+            struct timespec req = { 0, AGENT_IDLE_SLEEP_NS };
+            nanosleep(&req, NULL);
+        }
+    }
+
+    uint64_t rejected = 0;
+    for (unsigned int i = 0; i < games; i++) {
+        rejected += state[i].rejected;
+        termv_destroy(handles[i]);
+    }
+    if (rejected > 0)
+        fprintf(stderr, "termv: ignored %llu out-of-range agent actions\n",
+                (unsigned long long)rejected);
+    free(handles);
+    free(state);
+    munmap(seg, size);
+    unlink(path);
+    return 0;
+}
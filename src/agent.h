@@ -0,0 +1,156 @@
+#ifndef AGENT_H
+#define AGENT_H
+
+/*
+ * External-agent mode: `termv --agent PATH` maps PATH as a shared memory
+ * segment and serves one or more headless games through it.
+ *
+ * Segment layout: an AgentHeader followed by one AgentChannel per game.
+ * Each channel has two single-producer/single-consumer rings:
+ *
+ *   actions       agent -> termv   the agent pushes an AgentAction
+ *   observations  termv -> agent   termv answers with one AgentObservation
+ *
+ * Every action yields exactly one observation (after the action is applied
+ * and the game stepped by action.ticks). On startup termv publishes one
+ * observation per game with step = 0. An action code past the last
+ * TermvAction is ignored whole (no reset, no step): its observation
+ * repeats the game unchanged and counts it in `rejected`.
+ *
+ * Ring protocol: head is written only by the producer, tail only by the
+ * consumer, both as free-running counters. A slot is filled before head is
+ * published with release ordering, and read after head is loaded with
+ * acquire ordering; no locks or syscalls are involved. The inline helpers
+ * below implement this for C clients.
+ *
+ * Agents stop the host by setting header.shutdown to 1.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "termv.h"
+
+#define AGENT_MAGIC     0x41564D54u  /* "TMVA" little-endian */
+#define AGENT_VERSION   2
+#define AGENT_RING_SIZE 64           /* slots per ring, power of two */
+#define AGENT_MAX_GAMES 1024
+
+/* AgentAction.flags */
+#define AGENT_FLAG_RESET 1  /* start a new game with AgentAction.seed first */
+
+typedef struct {
+    uint8_t  action;  /* TermvAction */
+    uint8_t  flags;
+    uint16_t ticks;   /* milliseconds to step after the action */
+    uint32_t seed;
+} AgentAction;
+
+typedef struct {
+    uint64_t step;                      /* actions applied since start */
+    uint16_t rows[TERMV_BOARD_HEIGHT];  /* bit c set = column c filled */
+    int16_t  piece_row;
+    int16_t  piece_col;
+    uint8_t  piece_type;                /* TermvPieceType */
+    uint8_t  piece_rotation;
+    uint8_t  next_type;
+    uint8_t  state;                     /* TermvState */
+    uint32_t score;
+    uint32_t lines;
+    uint32_t level;
+    uint8_t  locking;
+    uint8_t  pad[3];
+    float    gravity_interval;          /* milliseconds */
+    float    gravity_timer;
+    float    lock_timer;
+    uint32_t rejected;                  /* out-of-range actions ignored */
+} AgentObservation;
+
+/* head and tail sit on separate cache lines to avoid false sharing. */
+typedef struct {
+    uint32_t    head;
+    uint8_t     pad0[60];
+    uint32_t    tail;
+    uint8_t     pad1[60];
+    AgentAction slots[AGENT_RING_SIZE];
+} AgentActionRing;
+
+typedef struct {
+    uint32_t         head;
+    uint8_t          pad0[60];
+    uint32_t         tail;
+    uint8_t          pad1[60];
+    AgentObservation slots[AGENT_RING_SIZE];
+} AgentObservationRing;
+
+typedef struct {
+    AgentActionRing      actions;
+    AgentObservationRing observations;
+} AgentChannel;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t games;
+    uint32_t ring_size;
+    uint32_t ready;     /* set to 1 by termv once the segment is initialized */
+    uint32_t shutdown;  /* set to 1 by the agent to stop termv */
+    uint8_t  pad[40];
+} AgentHeader;
+
+static inline AgentChannel *agent_channel(void *segment, uint32_t game) {
+    return (AgentChannel *)((char *)segment + sizeof(AgentHeader)) + game;
+}
+
+static inline size_t agent_segment_size(uint32_t games) {
+    return sizeof(AgentHeader) + (size_t)games * sizeof(AgentChannel);
+}
+
+/* Producer side of the action ring. Returns 0 if the ring is full. */
+static inline int agent_push_action(AgentActionRing *r, const AgentAction *a) {
+    uint32_t head = r->head;
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) == AGENT_RING_SIZE)
+        return 0;
+    r->slots[head & (AGENT_RING_SIZE - 1)] = *a;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Consumer side of the action ring. Returns 0 if the ring is empty. */
+static inline int agent_pop_action(AgentActionRing *r, AgentAction *out) {
+    uint32_t tail = r->tail;
+    if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == tail)
+        return 0;
+    *out = r->slots[tail & (AGENT_RING_SIZE - 1)];
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Producer side of the observation ring. Returns 0 if the ring is full. */
+static inline int agent_push_observation(AgentObservationRing *r,
+                                         const AgentObservation *o) {
+    uint32_t head = r->head;
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) == AGENT_RING_SIZE)
+        return 0;
+    r->slots[head & (AGENT_RING_SIZE - 1)] = *o;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Consumer side of the observation ring. Returns 0 if the ring is empty. */
+static inline int agent_pop_observation(AgentObservationRing *r,
+                                        AgentObservation *out) {
+    uint32_t tail = r->tail;
+    if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == tail)
+        return 0;
+    *out = r->slots[tail & (AGENT_RING_SIZE - 1)];
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/*
+ * Create PATH, serve `games` games seeded seed, seed+1, ... until an agent
+ * sets header.shutdown. Returns 0 on clean shutdown, 1 on setup failure.
+ */
+int agent_run(const char *path, unsigned int games, unsigned int seed);
+
+#endif
@@ -0,0 +1,561 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "termv.h"
+#include "game.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_X86 1
+#endif
+
+/*
+ * Structure-of-arrays layout: every per-game field is an array indexed by
+ * lane, padded to a multiple of LANE_ALIGN lanes. Boards are stored row by
+ * row across lanes as 32-bit words: the 10 columns sit at bits WALL..WALL+9
+ * and every other bit is set, so the side walls collide like filled cells.
+ * Solid rows above and below the board do the same for the ceiling and
+ * floor. A collision test is then four shifted ANDs with no bounds checks,
+ * which the AVX2 kernel runs for 8 games at a time.
+ */
+#define LANE_ALIGN 8
+#define WALL       8
+#define CEIL_ROWS  4
+#define FLOOR_ROWS 4
+#define ROW_COUNT  (CEIL_ROWS + BOARD_HEIGHT + FLOOR_ROWS)
+#define ROW_FULL   0xFFFFFFFFu
+#define ROW_EMPTY  (~((((uint32_t)1 << BOARD_WIDTH) - 1) << WALL))
+
+#define SOFT_DROP_INTERVAL 50.0  /* matches game_get_gravity_interval */
+#define LOCK_DELAY         500.0 /* matches game_init */
+
+/* What a lane does during a step, decided before anything moves */
+enum { MODE_IDLE, MODE_FLASH, MODE_LOCKING, MODE_GRAVITY };
+
+struct TermvBatch {
+    unsigned count;
+    unsigned stride;     /* count rounded up to LANE_ALIGN */
+    int      use_avx2;
+    RotationSystem rotation;
+
+    uint32_t *rows;      /* [ROW_COUNT][stride] */
+
+    int32_t  *type;
+    int32_t  *rot;
+    int32_t  *row;
+    int32_t  *col;
+    int32_t  *next;
+    int32_t  *state;
+    int32_t  *locking;
+    int32_t  *soft;
+    int32_t  *score;
+    int32_t  *lines;
+    int32_t  *level;
+    int32_t  *flash_active;
+    int32_t  *flash_count;
+    int32_t  *mode;
+    int32_t  *due;
+    int32_t  *ok;
+
+    double   *gravity_timer;
+    double   *gravity_interval;
+    double   *lock_timer;
+    double   *flash_timer;
+
+    PieceType    (*bag)[7];
+    int          *bag_index;
+    Rng          *rng;
+
+    /* Piece row masks at column 0, [type * 4 + rotation][row in 4x4 box] */
+    int32_t masks[PIECE_COUNT * 4][4];
+};
+
+/* ── Allocation ──────────────────────────────────────────────────── */
+
+static void *lane_alloc(size_t n, size_t size) {
+    void *p = NULL;
+    if (posix_memalign(&p, 32, n * size) != 0)
+        return NULL;
+    memset(p, 0, n * size);
+    return p;
+}
+
+static void build_masks(TermvBatch *b) {
+    memset(b->masks, 0, sizeof(b->masks));
+    for (int t = 0; t < PIECE_COUNT; t++) {
+        for (int r = 0; r < 4; r++) {
+            Piece p = { (PieceType)t, r, 0, 0, b->rotation };
+            int cells[4][2];
+            piece_get_cells(&p, cells);
+            for (int i = 0; i < 4; i++)
+                b->masks[t * 4 + r][cells[i][0]] |= 1 << cells[i][1];
+        }
+    }
+}
+
+/* ── Collision ───────────────────────────────────────────────────── */
+
+static uint32_t *row_at(const TermvBatch *b, int board_row) {
+    return b->rows + (size_t)(board_row + CEIL_ROWS) * b->stride;
+}
+
+static int lane_fits(const TermvBatch *b, unsigned k, int type, int rot,
+                     int row, int col) {
+    int base = row + CEIL_ROWS;
+    int shift = col + WALL;
+    if (base < 0 || base + 3 >= ROW_COUNT || shift < 0 || shift > 28)
+        return 0;
+
+    const int32_t *m = b->masks[type * 4 + rot];
+    uint32_t hit = 0;
+    for (int i = 0; i < 4; i++)
+        hit |= ((uint32_t)m[i] << shift) & b->rows[(size_t)(base + i) * b->stride + k];
+    return hit == 0;
+}
+
+/* ok[k] = current piece of lane k fits one row down, for every lane with due[k] */
+static void fits_down_scalar(TermvBatch *b) {
+    for (unsigned k = 0; k < b->stride; k++) {
+        if (b->due[k])
+            b->ok[k] = lane_fits(b, k, b->type[k], b->rot[k], b->row[k] + 1, b->col[k]);
+    }
+}
+
+#ifdef BATCH_X86
+__attribute__((target("avx2")))
+static void fits_down_avx2(TermvBatch *b) {
+    const __m256i lane_step = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i stride = _mm256_set1_epi32((int)b->stride);
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (unsigned k = 0; k < b->stride; k += 8) {
+        __m256i due = _mm256_load_si256((const __m256i *)(b->due + k));
+        if (_mm256_testz_si256(due, due))
+            continue;
+
+        __m256i type = _mm256_load_si256((const __m256i *)(b->type + k));
+        __m256i rot = _mm256_load_si256((const __m256i *)(b->rot + k));
+        __m256i row = _mm256_load_si256((const __m256i *)(b->row + k));
+        __m256i col = _mm256_load_si256((const __m256i *)(b->col + k));
+
+        __m256i shape = _mm256_slli_epi32(_mm256_add_epi32(_mm256_slli_epi32(type, 2), rot), 2);
+        __m256i shift = _mm256_add_epi32(col, _mm256_set1_epi32(WALL));
+        __m256i base = _mm256_add_epi32(row, _mm256_set1_epi32(CEIL_ROWS + 1));
+        __m256i lane = _mm256_add_epi32(_mm256_set1_epi32((int)k), lane_step);
+        __m256i hit = zero;
+
+        for (int i = 0; i < 4; i++) {
+            __m256i mask = _mm256_i32gather_epi32(&b->masks[0][i], shape, 4);
+            __m256i idx = _mm256_add_epi32(
+                _mm256_mullo_epi32(_mm256_add_epi32(base, _mm256_set1_epi32(i)), stride),
+                lane);
+            __m256i cells = _mm256_i32gather_epi32((const int *)b->rows, idx, 4);
+            hit = _mm256_or_si256(hit, _mm256_and_si256(_mm256_sllv_epi32(mask, shift), cells));
+        }
+
+        /* ok = (hit == 0), as 0/1 per lane */
+        __m256i ok = _mm256_srli_epi32(_mm256_cmpeq_epi32(hit, zero), 31);
+        _mm256_store_si256((__m256i *)(b->ok + k), ok);
+    }
+}
+#endif
+
+static void fits_down(TermvBatch *b) {
+#ifdef BATCH_X86
+    if (b->use_avx2) {
+        fits_down_avx2(b);
+        return;
+    }
+#endif
+    fits_down_scalar(b);
+}
+
+/* ── Per-lane rules (mirror game.c) ─────────────────────────────── */
+
+static void lane_new_piece(TermvBatch *b, unsigned k) {
+    Piece p;
+    piece_spawn(&p, (PieceType)b->next[k], b->rotation);
+    b->next[k] = (int32_t)bag_draw(b->bag[k], &b->bag_index[k], &b->rng[k]);
+
+    b->type[k] = p.type;
+    b->rot[k] = p.rotation;
+    b->row[k] = p.row;
+    b->col[k] = p.col;
+    b->locking[k] = 0;
+    b->lock_timer[k] = 0.0;
+    b->gravity_timer[k] = 0.0;
+
+    if (!lane_fits(b, k, p.type, p.rotation, p.row, p.col))
+        b->state[k] = STATE_GAMEOVER;
+}
+
+static void lane_init(TermvBatch *b, unsigned k, unsigned int seed) {
+    for (int r = -CEIL_ROWS; r < BOARD_HEIGHT + FLOOR_ROWS; r++)
+        row_at(b, r)[k] = (r < 0 || r >= BOARD_HEIGHT) ? ROW_FULL : ROW_EMPTY;
+
+    b->state[k] = STATE_INIT;
+    b->score[k] = 0;
+    b->lines[k] = 0;
+    b->level[k] = 0;
+    b->soft[k] = 0;
+    b->gravity_interval[k] = game_level_gravity_interval(0);
+    b->flash_active[k] = 0;
+    b->flash_timer[k] = 0.0;
+    b->flash_count[k] = 0;
+    b->bag_index[k] = 7;
+    rng_seed(&b->rng[k], seed);
+
+    b->next[k] = (int32_t)bag_draw(b->bag[k], &b->bag_index[k], &b->rng[k]);
+    lane_new_piece(b, k);
+    if (b->state[k] == STATE_INIT)
+        b->state[k] = STATE_RUNNING;
+}
+
+static void lane_clear_lines(TermvBatch *b, unsigned k, int top, int bottom) {
+    int cleared = 0;
+
+    /* Only rows the piece touched can have filled up; top to bottom keeps indices valid */
+    for (int r = top; r <= bottom; r++) {
+        if (row_at(b, r)[k] != ROW_FULL)
+            continue;
+        for (int rr = r; rr > 0; rr--)
+            row_at(b, rr)[k] = row_at(b, rr - 1)[k];
+        row_at(b, 0)[k] = ROW_EMPTY;
+        cleared++;
+    }
+    if (cleared == 0)
+        return;
+
+    b->score[k] += game_line_clear_score(cleared, b->level[k]);
+    b->lines[k] += cleared;
+    if (cleared == 4) {
+        b->flash_active[k] = 1;
+        b->flash_timer[k] = 0.0;
+        b->flash_count[k] = 4;
+    }
+    int new_level = b->lines[k] / 10;
+    if (new_level > b->level[k]) {
+        b->level[k] = new_level;
+        b->gravity_interval[k] = game_level_gravity_interval(new_level);
+    }
+}
+
+static void lane_lock(TermvBatch *b, unsigned k) {
+    const int32_t *m = b->masks[b->type[k] * 4 + b->rot[k]];
+    int top = BOARD_HEIGHT, bottom = -1;
+
+    for (int i = 0; i < 4; i++) {
+        if (!m[i])
+            continue;
+        int r = b->row[k] + i;
+        row_at(b, r)[k] |= (uint32_t)m[i] << (b->col[k] + WALL);
+        if (r < top)
+            top = r;
+        bottom = r;
+    }
+
+    lane_clear_lines(b, k, top, bottom);
+    lane_new_piece(b, k);
+}
+
+/* After a successful move or rotate during lock delay */
+static void lane_reset_lock(TermvBatch *b, unsigned k) {
+    if (!b->locking[k])
+        return;
+    b->lock_timer[k] = 0.0;
+    if (lane_fits(b, k, b->type[k], b->rot[k], b->row[k] + 1, b->col[k]))
+        b->locking[k] = 0;
+}
+
+static void lane_move(TermvBatch *b, unsigned k, int drow, int dcol) {
+    if (b->state[k] != STATE_RUNNING)
+        return;
+    if (!lane_fits(b, k, b->type[k], b->rot[k], b->row[k] + drow, b->col[k] + dcol))
+        return;
+    b->row[k] += drow;
+    b->col[k] += dcol;
+    lane_reset_lock(b, k);
+}
+
+static void lane_rotate(TermvBatch *b, unsigned k, int dir) {
+    if (b->state[k] != STATE_RUNNING)
+        return;
+
+    const KickList *kl = piece_kicks(b->rotation, (PieceType)b->type[k], b->rot[k], dir);
+    int rot = (b->rot[k] + dir + 4) & 3;
+    for (int i = 0; i < kl->count; i++) {
+        int dr = kl->kicks[i].drow, dc = kl->kicks[i].dcol;
+        if (lane_fits(b, k, b->type[k], rot, b->row[k] + dr, b->col[k] + dc)) {
+            b->rot[k] = rot;
+            b->row[k] += dr;
+            b->col[k] += dc;
+            lane_reset_lock(b, k);
+            return;
+        }
+    }
+}
+
+static void lane_hard_drop(TermvBatch *b, unsigned k) {
+    if (b->state[k] != STATE_RUNNING)
+        return;
+    int dropped = 0;
+    while (lane_fits(b, k, b->type[k], b->rot[k], b->row[k] + 1, b->col[k])) {
+        b->row[k]++;
+        dropped++;
+    }
+    b->score[k] += dropped * 2;
+    lane_lock(b, k);
+}
+
+static void lane_apply(TermvBatch *b, unsigned k, TermvAction action) {
+    switch (action) {
+        case TERMV_ACTION_LEFT:
+            lane_move(b, k, 0, -1);
+            break;
+        case TERMV_ACTION_RIGHT:
+            lane_move(b, k, 0, 1);
+            break;
+        case TERMV_ACTION_SOFT_DROP:
+            b->soft[k] = 1;
+            lane_move(b, k, 1, 0);
+            break;
+        case TERMV_ACTION_SOFT_DROP_RELEASE:
+            b->soft[k] = 0;
+            break;
+        case TERMV_ACTION_ROTATE_CW:
+            lane_rotate(b, k, -1);
+            break;
+        case TERMV_ACTION_ROTATE_CCW:
+            lane_rotate(b, k, 1);
+            break;
+        case TERMV_ACTION_HARD_DROP:
+            lane_hard_drop(b, k);
+            break;
+        case TERMV_ACTION_PAUSE:
+            if (b->state[k] == STATE_RUNNING)
+                b->state[k] = STATE_PAUSED;
+            else if (b->state[k] == STATE_PAUSED)
+                b->state[k] = STATE_RUNNING;
+            break;
+        case TERMV_ACTION_NONE:
+            break;
+    }
+}
+
+static void lane_update_flash(TermvBatch *b, unsigned k, double dt) {
+    b->flash_timer[k] += dt;
+    if (b->flash_timer[k] >= 100.0) {
+        b->flash_timer[k] -= 100.0;
+        if (--b->flash_count[k] <= 0) {
+            b->flash_active[k] = 0;
+            b->flash_count[k] = 0;
+        }
+    }
+}
+
+/* ── Stepping ────────────────────────────────────────────────────── */
+
+/*
+ * Same control flow as game_update() / game_apply_gravity(), across lanes.
+ * Returns 0 once every lane is idle, so nothing later ticks could change.
+ */
+static int batch_update(TermvBatch *b, double dt) {
+    unsigned n = b->stride;
+    int any_due = 0, any_active = 0;
+
+    for (unsigned k = 0; k < n; k++) {
+        int running = b->state[k] == STATE_RUNNING;
+        b->mode[k] = b->flash_active[k] ? MODE_FLASH
+                   : !running           ? MODE_IDLE
+                   : b->locking[k]      ? MODE_LOCKING
+                   :                      MODE_GRAVITY;
+        any_active |= b->mode[k] != MODE_IDLE;
+    }
+    if (!any_active)
+        return 0;
+
+    for (unsigned k = 0; k < b->count; k++) {
+        if (b->mode[k] == MODE_FLASH) {
+            lane_update_flash(b, k, dt);
+        } else if (b->mode[k] == MODE_LOCKING) {
+            b->lock_timer[k] += dt;
+            if (b->lock_timer[k] >= LOCK_DELAY)
+                lane_lock(b, k);
+        }
+    }
+
+    /* Branch-free timer pass over all lanes; vectorizes on any target */
+    for (unsigned k = 0; k < n; k++) {
+        int active = b->mode[k] == MODE_GRAVITY;
+        double interval = b->soft[k] ? SOFT_DROP_INTERVAL : b->gravity_interval[k];
+        b->gravity_timer[k] += active ? dt : 0.0;
+        b->due[k] = active & (b->gravity_timer[k] >= interval);
+        any_due |= b->due[k];
+    }
+
+    /* Gravity steps: test every due lane at once, then resolve per lane */
+    while (any_due) {
+        fits_down(b);
+        any_due = 0;
+        for (unsigned k = 0; k < n; k++) {
+            if (!b->due[k])
+                continue;
+            double interval = b->soft[k] ? SOFT_DROP_INTERVAL : b->gravity_interval[k];
+            b->gravity_timer[k] -= interval;
+            if (b->ok[k]) {
+                b->row[k]++;
+                b->score[k] += b->soft[k];
+                b->due[k] = b->gravity_timer[k] >= interval;
+            } else {
+                b->locking[k] = 1;
+                b->lock_timer[k] = 0.0;
+                b->due[k] = 0;
+            }
+            any_due |= b->due[k];
+        }
+    }
+    return 1;
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+TermvBatch *termv_batch_create(unsigned int count, unsigned int seed) {
+    if (count == 0)
+        return NULL;
+
+    TermvBatch *b = calloc(1, sizeof(*b));
+    if (!b)
+        return NULL;
+    b->count = count;
+    b->stride = (count + LANE_ALIGN - 1) / LANE_ALIGN * LANE_ALIGN;
+    size_t n = b->stride;
+
+    b->rows = lane_alloc((size_t)ROW_COUNT * n, sizeof(uint32_t));
+    int32_t **i32[] = {
+        &b->type, &b->rot, &b->row, &b->col, &b->next, &b->state, &b->locking,
+        &b->soft, &b->score, &b->lines, &b->level, &b->flash_active,
+        &b->flash_count, &b->mode, &b->due, &b->ok
+    };
+    double **f64[] = {
+        &b->gravity_timer, &b->gravity_interval, &b->lock_timer, &b->flash_timer
+    };
+    int ok = b->rows != NULL;
+    for (size_t i = 0; i < sizeof(i32) / sizeof(i32[0]); i++)
+        ok &= (*i32[i] = lane_alloc(n, sizeof(int32_t))) != NULL;
+    for (size_t i = 0; i < sizeof(f64) / sizeof(f64[0]); i++)
+        ok &= (*f64[i] = lane_alloc(n, sizeof(double))) != NULL;
+    b->bag = calloc(n, sizeof(*b->bag));
+    b->bag_index = calloc(n, sizeof(*b->bag_index));
+    b->rng = calloc(n, sizeof(*b->rng));
+    if (!ok || !b->bag || !b->bag_index || !b->rng) {
+        termv_batch_destroy(b);
+        return NULL;
+    }
+
+#ifdef BATCH_X86
+    __builtin_cpu_init();
+    b->use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    build_masks(b);
+    for (unsigned k = 0; k < b->stride; k++) {
+        lane_init(b, k, seed + k);
+        if (k >= count)
+            b->state[k] = STATE_GAMEOVER;  /* padding lanes never move */
+    }
+    return b;
+}
+
+void termv_batch_destroy(TermvBatch *b) {
+    if (!b)
+        return;
+    free(b->rows);
+    free(b->type);
+    free(b->rot);
+    free(b->row);
+    free(b->col);
+    free(b->next);
+    free(b->state);
+    free(b->locking);
+    free(b->soft);
+    free(b->score);
+    free(b->lines);
+    free(b->level);
+    free(b->flash_active);
+    free(b->flash_count);
+    free(b->mode);
+    free(b->due);
+    free(b->ok);
+    free(b->gravity_timer);
+    free(b->gravity_interval);
+    free(b->lock_timer);
+    free(b->flash_timer);
+    free(b->bag);
+    free(b->bag_index);
+    free(b->rng);
+    free(b);
+}
+
+unsigned termv_batch_count(const TermvBatch *b) {
+    return b->count;
+}
+
+void termv_batch_reset(TermvBatch *b, unsigned int lane, unsigned int seed) {
+    if (lane < b->count)
+        lane_init(b, lane, seed);
+}
+
+void termv_batch_set_rotation(TermvBatch *b, TermvRotation rs) {
+    if ((unsigned)rs >= ROTATION_COUNT)
+        return;
+    b->rotation = (RotationSystem)rs;
+    build_masks(b);
+
+    /* Return each running game's piece to spawn in the new system */
+    for (unsigned k = 0; k < b->count; k++) {
+        if (b->state[k] != STATE_RUNNING && b->state[k] != STATE_PAUSED)
+            continue;
+        Piece p;
+        piece_spawn(&p, (PieceType)b->type[k], b->rotation);
+        b->rot[k] = p.rotation;
+        b->row[k] = p.row;
+        b->col[k] = p.col;
+        if (!lane_fits(b, k, p.type, p.rotation, p.row, p.col))
+            b->state[k] = STATE_GAMEOVER;
+    }
+}
+
+void termv_batch_step(TermvBatch *b, const TermvAction *actions,
+                      unsigned int ticks) {
+    if (actions) {
+        for (unsigned k = 0; k < b->count; k++) {
+            if (actions[k] != TERMV_ACTION_NONE)
+                lane_apply(b, k, actions[k]);
+        }
+    }
+    /* A tick at a time, as termv_step() */
+    for (; ticks > 0; ticks--) {
+        if (!batch_update(b, 1.0))
+            break;
+    }
+}
+
+int termv_batch_lane(const TermvBatch *b, unsigned int lane, TermvLane *out) {
+    if (lane >= b->count)
+        return 0;
+    unsigned k = lane;
+    out->state = (TermvState)b->state[k];
+    out->score = b->score[k];
+    out->lines = b->lines[k];
+    out->level = b->level[k];
+    out->next = b->next[k];
+    out->current.type = b->type[k];
+    out->current.rotation = b->rot[k];
+    out->current.row = b->row[k];
+    out->current.col = b->col[k];
+    for (int r = 0; r < BOARD_HEIGHT; r++)
+        out->rows[r] = (unsigned short)((row_at(b, r)[k] >> WALL) & ((1u << BOARD_WIDTH) - 1));
+    return 1;
+}
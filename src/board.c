@@ -1,62 +1,216 @@
 #include "board.h"
 #include <string.h>
 
-int board[BOARD_HEIGHT][BOARD_WIDTH];
+/* ── Row keys ────────────────────────────────────────────────────── */
 
-void board_init(void) {
-    memset(board, 0, sizeof(board));
+/*
+ * Base of the polynomial hash and its inverse mod 2^64. P = 3 (mod 8)
+ * keeps P^i - P^j (i != j < 64) to at most 7 factors of two, so swapping
+ * two rows changes the hash.
+ */
+#define HASH_P     0xD6E8FEB86659FD93ull
+#define HASH_P_INV 0xCFEE444D8B59A89Bull
+
+/* Key of one row's occupancy, independent of where the row is */
+static uint64_t content_key(unsigned bits) {
+    if (bits == 0)
+        return 0;
+    uint64_t z = bits + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/* P^e for 0 <= e < 64, by squaring */
+static uint64_t power(int e) {
+    uint64_t result = 1, x = HASH_P;
+    for (; e > 0; e >>= 1) {
+        if (e & 1)
+            result *= x;
+        x *= x;
+    }
+    return result;
+}
+
+uint64_t board_row_key(int row, unsigned bits) {
+    return content_key(bits) * power(BOARD_HEIGHT - 1 - row);
+}
+
+uint64_t board_hash(const Board *b) {
+    return b->hash;
 }
 
-int board_cell(int row, int col) {
+/* ── Cells ───────────────────────────────────────────────────────── */
+
+/* Slot of logical row r in the ring */
+static int slot(const Board *b, int r) {
+    int i = b->base + r;
+    return i >= BOARD_HEIGHT ? i - BOARD_HEIGHT : i;
+}
+
+static int phys_row(const Board *b, int r) {
+    return b->ring[slot(b, r)];
+}
+
+void board_init(Board *b) {
+    memset(b->cells, 0, sizeof(b->cells));
+    memset(b->row_fill, 0, sizeof(b->row_fill));
+    memset(b->row_bits, 0, sizeof(b->row_bits));
+    for (int r = 0; r < BOARD_HEIGHT; r++)
+        b->ring[r] = r;
+    b->base = 0;
+    b->top = BOARD_HEIGHT;
+    b->full = 0;
+    b->hash = 0;
+}
+
+int board_cell(const Board *b, int row, int col) {
     if (row < 0 || row >= BOARD_HEIGHT || col < 0 || col >= BOARD_WIDTH)
         return -1;
-    return board[row][col];
+    return b->cells[phys_row(b, row)][col];
 }
 
-void board_set(int row, int col, int val) {
-    if (row >= 0 && row < BOARD_HEIGHT && col >= 0 && col < BOARD_WIDTH)
-        board[row][col] = val;
+const int *board_row(const Board *b, int row) {
+    return b->cells[phys_row(b, row)];
 }
 
-int board_is_empty(int row, int col) {
-    return board_cell(row, col) == 0;
+unsigned board_row_bits(const Board *b, int row) {
+    return b->row_bits[phys_row(b, row)];
+}
+
+void board_set(Board *b, int row, int col, int val) {
+    if (row < 0 || row >= BOARD_HEIGHT || col < 0 || col >= BOARD_WIDTH)
+        return;
+    int phys = phys_row(b, row);
+    int old = b->cells[phys][col];
+    b->cells[phys][col] = val;
+    if ((val != 0) == (old != 0))
+        return;
+
+    unsigned bits = b->row_bits[phys] ^ (1u << col);
+    b->hash += (content_key(bits) - content_key(b->row_bits[phys]))
+             * power(BOARD_HEIGHT - 1 - row);
+    b->row_bits[phys] = bits;
+    b->row_fill[phys] += (val != 0) - (old != 0);
+    if (val != 0 && row < b->top)
+        b->top = row;
+    if (b->row_fill[phys] == BOARD_WIDTH)
+        b->full |= 1ull << row;
+    else
+        b->full &= ~(1ull << row);
+}
+
+int board_is_empty(const Board *b, int row, int col) {
+    return board_cell(b, row, col) == 0;
 }
 
 int board_in_bounds(int row, int col) {
     return row >= 0 && row < BOARD_HEIGHT && col >= 0 && col < BOARD_WIDTH;
 }
 
-void board_lock(int coords[4][2], int color_id) {
+void board_lock(Board *b, int coords[4][2], int color_id) {
     for (int i = 0; i < 4; i++) {
         int r = coords[i][0];
         int c = coords[i][1];
-        board_set(r, c, color_id);
+        board_set(b, r, c, color_id);
     }
 }
 
-int board_clear_lines(void) {
-    int cleared = 0;
+static void clear_phys_row(Board *b, int phys) {
+    memset(b->cells[phys], 0, sizeof(b->cells[phys]));
+    b->row_fill[phys] = 0;
+    b->row_bits[phys] = 0;
+}
+
+/*
+ * Remove full row c; the rows above it drop by one. Either the stack
+ * above c moves down a slot, or the rows below c move up a slot and the
+ * ring turns back by one, whichever moves fewer rows. Only the rows above
+ * change position, so their share of the hash is divided by P; the loop
+ * that moves rows sums whichever share it passes over.
+ */
+static void remove_row(Board *b, int c) {
+    int freed = phys_row(b, c);
+    b->hash -= board_row_key(c, b->row_bits[freed]);
+    clear_phys_row(b, freed);
 
-    for (int r = BOARD_HEIGHT - 1; r >= 0; r--) {
-        int full = 1;
-        for (int c = 0; c < BOARD_WIDTH; c++) {
-            if (board[r][c] == 0) {
-                full = 0;
-                break;
-            }
+    uint64_t above;
+    if (c - b->top <= BOARD_HEIGHT - 1 - c) {
+        uint64_t w = power(BOARD_HEIGHT - c);
+        above = 0;
+        for (int r = c; r > b->top; r--, w *= HASH_P) {
+            int moved = b->ring[slot(b, r - 1)];
+            above += content_key(b->row_bits[moved]) * w;
+            b->ring[slot(b, r)] = moved;
         }
-        if (full) {
-            cleared++;
-            /* Shift all rows above down by 1 */
-            for (int rr = r; rr > 0; rr--) {
-                memcpy(board[rr], board[rr - 1], sizeof(board[rr]));
-            }
-            /* Clear top row */
-            memset(board[0], 0, sizeof(board[0]));
-            /* Re-check this row since it now has new content */
-            r++;
+        b->ring[slot(b, b->top)] = freed;
+    } else {
+        uint64_t w = power(BOARD_HEIGHT - 2 - c), below = 0;
+        for (int r = c; r < BOARD_HEIGHT - 1; r++, w *= HASH_P_INV) {
+            int moved = b->ring[slot(b, r + 1)];
+            below += content_key(b->row_bits[moved]) * w;
+            b->ring[slot(b, r)] = moved;
         }
+        b->ring[slot(b, BOARD_HEIGHT - 1)] = freed;
+        b->base = b->base == 0 ? BOARD_HEIGHT - 1 : b->base - 1;
+        above = b->hash - below;
     }
+    b->hash += above * HASH_P_INV - above;
+    b->top++;
+}
+
+int board_clear_lines(Board *b) {
+    int cleared = 0;
 
+    /* Top-most first: removing a row leaves the full rows below it in place */
+    while (b->full) {
+        int c = __builtin_ctzll(b->full);
+        b->full &= ~(1ull << c);
+        remove_row(b, c);
+        cleared++;
+    }
     return cleared;
 }
+
+int board_add_garbage(Board *b, int count, int hole_col, int color_id) {
+    if (count <= 0)
+        return 0;
+    if (count > BOARD_HEIGHT)
+        count = BOARD_HEIGHT;
+
+    /* Rows pushed off the top; any content there means a top-out */
+    int overflow = 0;
+    for (int r = b->top; r < count; r++) {
+        unsigned bits = b->row_bits[phys_row(b, r)];
+        overflow |= bits != 0;
+        b->hash -= board_row_key(r, bits);
+    }
+
+    /* Surviving rows move up by count */
+    b->hash *= power(count);
+
+    /* Turn the ring: the popped rows come around as the bottom rows */
+    b->base = slot(b, count % BOARD_HEIGHT);
+    b->top = b->top > count ? b->top - count : 0;
+    b->full = count < 64 ? b->full >> count : 0;
+
+    int hole = hole_col >= 0 && hole_col < BOARD_WIDTH;
+    unsigned full = (1u << BOARD_WIDTH) - 1;
+    unsigned bits = hole ? full & ~(1u << hole_col) : full;
+    uint64_t key = content_key(bits), w = power(count - 1);
+    for (int i = 0; i < count; i++, w *= HASH_P_INV) {
+        int row = BOARD_HEIGHT - count + i;
+        int phys = phys_row(b, row);
+        for (int c = 0; c < BOARD_WIDTH; c++)
+            b->cells[phys][c] = (c == hole_col) ? 0 : color_id;
+        b->row_fill[phys] = hole ? BOARD_WIDTH - 1 : BOARD_WIDTH;
+        b->row_bits[phys] = bits;
+        b->hash += key * w;
+        if (!hole)
+            b->full |= 1ull << row;
+    }
+    if (count > 0 && b->top > BOARD_HEIGHT - count)
+        b->top = BOARD_HEIGHT - count;
+
+    return overflow;
+}
@@ -1,24 +1,75 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include <stdint.h>
+
 #define BOARD_WIDTH  10
 #define BOARD_HEIGHT 40
 #define VISIBLE_HEIGHT 20
 #define HIDDEN_HEIGHT  20
 
-/* Each cell: 0 = empty, 1-7 = piece color ID */
-extern int board[BOARD_HEIGHT][BOARD_WIDTH];
+/*
+ * Playfield. Each cell: 0 = empty, 1-7 = piece color ID.
+ *
+ * Rows are stored out of order: cells[] is the physical storage and
+ * ring[] lists the physical rows in board order, starting at ring[base]
+ * for logical row 0 (the top). Pushing garbage advances base and refills
+ * only the rows that wrap around; clearing a line shifts whichever is
+ * shorter, the stack above it or the rows below it, and recycles the
+ * cleared row. full marks the rows board_set() filled, so finding lines
+ * to clear needs no scan. Access cells through the functions below.
+ *
+ * hash is a polynomial hash of occupancy (colors are ignored): the sum
+ * of board_row_key(row, bits) = K(bits) * P^(BOARD_HEIGHT-1-row) over all
+ * rows, mod 2^64. K depends only on a row's contents, so moving a run of
+ * rows by k places multiplies its share by P^k: clearing a line or
+ * pushing garbage costs no more hashing than the ring moves it makes.
+ * Searches can key transposition tables on it for free.
+ */
+typedef struct {
+    int      cells[BOARD_HEIGHT][BOARD_WIDTH];
+    int      ring[BOARD_HEIGHT];      /* physical rows in board order, from base */
+    int      base;
+    int      top;                     /* rows above this logical row are empty */
+    uint64_t full;                    /* bit r: logical row r is full */
+    int      row_fill[BOARD_HEIGHT];  /* occupied cells per physical row */
+    unsigned row_bits[BOARD_HEIGHT];  /* occupancy mask per physical row */
+    uint64_t hash;
+} Board;
+
+void board_init(Board *b);
+int  board_cell(const Board *b, int row, int col);
+
+/* Read-only view of one logical row (BOARD_WIDTH cells). row must be in range. */
+const int *board_row(const Board *b, int row);
+
+/* Occupancy of one logical row as a bitmask: bit c set = column c is filled. */
+unsigned board_row_bits(const Board *b, int row);
 
-void board_init(void);
-int  board_cell(int row, int col);
-void board_set(int row, int col, int val);
-int  board_is_empty(int row, int col);
+/* Hash of the board's occupancy. */
+uint64_t board_hash(const Board *b);
+
+/*
+ * Hash contribution of logical row `row` holding occupancy `bits`; 0 for
+ * an empty row. K(bits) comes from a 64-bit mixer instead of a table.
+ */
+uint64_t board_row_key(int row, unsigned bits);
+
+void board_set(Board *b, int row, int col, int val);
+int  board_is_empty(const Board *b, int row, int col);
 int  board_in_bounds(int row, int col);
 
 /* Lock the active piece minos into the board. coords is [4][2] (row, col). */
-void board_lock(int coords[4][2], int color_id);
+void board_lock(Board *b, int coords[4][2], int color_id);
 
 /* Check and clear full lines. Returns number of lines cleared. */
-int  board_clear_lines(void);
+int  board_clear_lines(Board *b);
+
+/*
+ * Push count garbage rows up from the bottom. Each row is filled with
+ * color_id except for hole_col. Returns 1 if occupied rows were pushed
+ * off the top of the board (top-out), 0 otherwise.
+ */
+int  board_add_garbage(Board *b, int count, int hole_col, int color_id);
 
 #endif
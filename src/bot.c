@@ -0,0 +1,264 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "bot.h"
+#include "game.h"
+#include "movegen.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+#define FRAME_MAX   (2 + 255)
+#define PATH_MAX_MOVES 256
+
+enum {
+    END_TOPPED_OUT = 0,
+    END_ILLEGAL    = 1
+};
+
+typedef struct {
+    FILE    *to, *from;
+    pid_t    pid;
+    uint64_t bytes_sent, bytes_received;
+} Bot;
+
+/* ── Pipes ───────────────────────────────────────────────────────── */
+
+/* Start command under /bin/sh with its stdin and stdout on pipes. */
+static int bot_spawn(Bot *bot, const char *command) {
+    int in[2], out[2];  /* the bot's stdin and stdout */
+    if (pipe(in) != 0)
+        return 0;
+    if (pipe(out) != 0) {
+        close(in[0]);
+        close(in[1]);
+        return 0;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, in[0]);
+    posix_spawn_file_actions_addclose(&actions, in[1]);
+    posix_spawn_file_actions_addclose(&actions, out[0]);
+    posix_spawn_file_actions_addclose(&actions, out[1]);
+    char *argv[] = { (char *)"sh", (char *)"-c", (char *)command, NULL };
+    int err = posix_spawn(&bot->pid, "/bin/sh", &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    close(in[0]);
+    close(out[1]);
+    if (err != 0) {
+        close(in[1]);
+        close(out[0]);
+        return 0;
+    }
+    bot->to = fdopen(in[1], "wb");
+    bot->from = fdopen(out[0], "rb");
+    bot->bytes_sent = bot->bytes_received = 0;
+    return bot->to && bot->from;
+}
+
+/* Close the bot's stdin and wait for it. Returns its exit status. */
+static int bot_finish(Bot *bot) {
+    int status = 0;
+    if (bot->to)
+        fclose(bot->to);
+    if (bot->from)
+        fclose(bot->from);
+    if (waitpid(bot->pid, &status, 0) < 0)
+        return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/* Send one frame and flush it: the bot is waiting on it. */
+static int send_frame(Bot *bot, unsigned char type, const unsigned char *payload, int len) {
+    unsigned char header[2] = { type, (unsigned char)len };
+    if (fwrite(header, 1, 2, bot->to) != 2
+        || fwrite(payload, 1, (size_t)len, bot->to) != (size_t)len
+        || fflush(bot->to) != 0)
+        return 0;
+    bot->bytes_sent += 2 + (uint64_t)len;
+    return 1;
+}
+
+/* Read the next frame of the given type, skipping others. Returns 0 at EOF. */
+static int receive_frame(Bot *bot, unsigned char type, unsigned char *payload, int *len) {
+    unsigned char header[2];
+    for (;;) {
+        if (fread(header, 1, 2, bot->from) != 2
+            || fread(payload, 1, header[1], bot->from) != header[1])
+            return 0;
+        bot->bytes_received += 2 + (uint64_t)header[1];
+        if (header[0] == type) {
+            *len = header[1];
+            return 1;
+        }
+    }
+}
+
+static void put32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++)
+        p[i] = (unsigned char)(v >> (8 * i));
+}
+
+/* ── Games ───────────────────────────────────────────────────────── */
+
+/*
+ * Build a turn: the pieces revealed since the last one, and the rows that
+ * differ from sent[] (updated to the board). Returns the payload length.
+ */
+static int build_turn(const Game *g, int first, unsigned *sent, unsigned char *p) {
+    PieceType queue[BOT_PREVIEW];
+    int n = 0;
+
+    game_peek_queue(g, queue, BOT_PREVIEW);
+    if (first) {
+        p[n++] = BOT_PREVIEW + 2;
+        p[n++] = (unsigned char)g->current.type;
+        p[n++] = (unsigned char)g->next;
+        for (int i = 0; i < BOT_PREVIEW; i++)
+            p[n++] = (unsigned char)queue[i];
+    } else {
+        p[n++] = 1;
+        p[n++] = (unsigned char)queue[BOT_PREVIEW - 1];
+    }
+
+    int count_at = n++;
+    int rows = 0;
+    for (int r = 0; r < BOARD_HEIGHT; r++) {
+        unsigned bits = board_row_bits(&g->board, r);
+        if (bits == sent[r])
+            continue;
+        sent[r] = bits;
+        p[n++] = (unsigned char)r;
+        p[n++] = (unsigned char)bits;
+        p[n++] = (unsigned char)(bits >> 8);
+        rows++;
+    }
+    p[count_at] = (unsigned char)rows;
+    return n;
+}
+
+/* Carry out a placement with player moves. Returns 0 if it can't be reached. */
+static int place(Game *g, const unsigned char *p, int len, MoveScratch *scratch) {
+    if (len < 3)
+        return 0;
+    Piece target = g->current;
+    target.rotation = p[0] & 3;
+    target.row = (signed char)p[1];
+    target.col = (signed char)p[2];
+    if (!piece_valid(&g->board, &target))
+        return 0;
+    Piece below = target;
+    below.row++;
+    if (piece_valid(&g->board, &below))
+        return 0;  /* not resting */
+
+    unsigned char moves[PATH_MAX_MOVES];
+    int n = movegen_path(&g->board, &g->current, &target, moves, PATH_MAX_MOVES, scratch);
+    if (n < 0)
+        return 0;
+    for (int i = 0; i < n; i++) {
+        switch (moves[i]) {
+            case MOVE_LEFT:  game_move(g, 0, -1); break;
+            case MOVE_RIGHT: game_move(g, 0, 1); break;
+            case MOVE_DOWN:  game_move(g, 1, 0); break;
+            case MOVE_CCW:   game_rotate(g, 1); break;
+            default:         game_rotate(g, -1); break;
+        }
+    }
+    game_hard_drop(g);
+    return 1;
+}
+
+/* Play one game. Returns 0 if the bot went away mid-game. */
+static int play_game(Bot *bot, Game *g, unsigned seed, RotationSystem rs,
+                     MoveScratch *scratch) {
+    unsigned char p[FRAME_MAX];
+    unsigned sent[BOARD_HEIGHT] = { 0 };
+    int len;
+
+    game_init(g, seed);
+    game_set_rotation(g, rs);
+
+    put32(p, seed);
+    p[4] = (unsigned char)rs;
+    p[5] = BOARD_WIDTH;
+    p[6] = BOARD_HEIGHT;
+    if (!send_frame(bot, 'S', p, 7))
+        return 0;
+
+    int reason = END_TOPPED_OUT;
+    for (int first = 1; g->state == STATE_RUNNING; first = 0) {
+        len = build_turn(g, first, sent, p);
+        if (!send_frame(bot, 'T', p, len) || !receive_frame(bot, 'P', p, &len))
+            return 0;
+        if (!place(g, p, len, scratch)) {
+            reason = END_ILLEGAL;
+            break;
+        }
+    }
+
+    p[0] = (unsigned char)reason;
+    put32(p + 1, (uint32_t)g->score);
+    put32(p + 5, (uint32_t)g->lines);
+    put32(p + 9, g->stats.pieces);
+    send_frame(bot, 'E', p, 13);
+
+    printf("Game %u: score %d, lines %d, pieces %u%s\n", seed, g->score, g->lines,
+           g->stats.pieces, reason == END_ILLEGAL ? " (illegal placement)" : "");
+    return 1;
+}
+
+int bot_run(const BotOptions *opt) {
+    Bot bot;
+    MoveScratch *scratch = malloc(sizeof(*scratch));
+    Game *game = malloc(sizeof(*game));
+    if (!scratch || !game) {
+        fprintf(stderr, "termv: out of memory\n");
+        free(scratch);
+        free(game);
+        return 1;
+    }
+
+    /* A bot that exits early must show up as EOF, not kill termv */
+    signal(SIGPIPE, SIG_IGN);
+    if (!bot_spawn(&bot, opt->command)) {
+        perror("termv: cannot start bot");
+        free(scratch);
+        free(game);
+        return 1;
+    }
+
+    double started = util_now_seconds();
+    uint64_t pieces = 0;
+    unsigned played = 0;
+    int ok = 1;
+    for (; played < opt->games && ok; played++) {
+        ok = play_game(&bot, game, opt->seed + played, opt->rotation, scratch);
+        pieces += game->stats.pieces;
+    }
+    double elapsed = util_now_seconds() - started;
+    int status = bot_finish(&bot);
+
+    if (!ok)
+        fprintf(stderr, "termv: bot stopped answering during game %u\n", played);
+    printf("Bot: %u games, %llu pieces in %.2f s (%.0f pieces/s)\n", played,
+           (unsigned long long)pieces, elapsed, elapsed > 0 ? pieces / elapsed : 0.0);
+    printf("Protocol: %llu bytes sent, %llu received (%.1f + %.1f per piece)\n",
+           (unsigned long long)bot.bytes_sent, (unsigned long long)bot.bytes_received,
+           pieces ? (double)bot.bytes_sent / pieces : 0.0,
+           pieces ? (double)bot.bytes_received / pieces : 0.0);
+
+    free(scratch);
+    free(game);
+    return ok && status == 0 ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include "piece.h"
+
+/*
+ * Bot protocol (`termv --bot-protocol CMD`): termv runs CMD through
+ * /bin/sh with its stdin and stdout on pipes, and plays headless games in
+ * which the bot chooses every placement. No time passes between
+ * placements (no gravity or lock delay), as in perft.
+ *
+ * Frames both ways: u8 type, u8 payload length, payload. Integers are
+ * little-endian; rows count from 0 at the top of the 40-row board (rows
+ * 20-39 are visible), bit c of a row mask is column c.
+ *
+ * termv -> bot
+ *   'S' start    u32 seed, u8 rotation system (0 basic, 1 srs, 2 ars),
+ *                u8 board width, u8 board height
+ *   'T' turn     u8 n, n piece types appended to the queue;
+ *                u8 m, m x (u8 row, u16 mask) rows changed since the last turn
+ *   'E' end      u8 reason (0 topped out, 1 illegal placement),
+ *                u32 score, u32 lines, u32 pieces
+ *
+ * bot -> termv
+ *   'P' place    u8 rotation, i8 row, i8 col: the resting position of the
+ *                current piece (the queue's head), in piece.h coordinates
+ *
+ * The first turn of a game carries the current piece, the next one and
+ * BOT_PREVIEW more; every later turn reveals one piece. Each 'T' expects
+ * exactly one 'P'. termv carries the placement out with the same moves a
+ * player would make (shifts, soft drops, rotations, then a hard drop), so
+ * tucks and spins are allowed but unreachable spots are illegal. A
+ * typical turn is 8-17 bytes down and 5 bytes up.
+ */
+
+#define BOT_PREVIEW 5
+
+typedef struct {
+    const char    *command;
+    unsigned int   games;
+    unsigned int   seed;       /* game g uses seed + g */
+    RotationSystem rotation;
+} BotOptions;
+
+/* Play opt->games games with the bot and print a summary. Returns a process exit status. */
+int bot_run(const BotOptions *opt);
+
+#endif
@@ -0,0 +1,119 @@
+#include "canvas.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int canvas_init(Canvas *c, int width, int height) {
+    c->width = width;
+    c->height = height;
+    c->cells = malloc((size_t)width * (size_t)height * sizeof(*c->cells));
+    if (!c->cells)
+        return 0;
+    canvas_clear(c);
+    return 1;
+}
+
+void canvas_free(Canvas *c) {
+    free(c->cells);
+    c->cells = NULL;
+}
+
+void canvas_clear(Canvas *c) {
+    CanvasCell blank = { ' ', CANVAS_DEFAULT, 0 };
+    for (int i = 0; i < c->width * c->height; i++)
+        c->cells[i] = blank;
+}
+
+void canvas_set(Canvas *c, int y, int x, uint32_t ch, int fg, int attr) {
+    if (y < 0 || y >= c->height || x < 0 || x >= c->width)
+        return;
+    CanvasCell *cell = &c->cells[y * c->width + x];
+    cell->ch = ch;
+    cell->fg = (unsigned char)fg;
+    cell->attr = (unsigned char)attr;
+}
+
+void canvas_text(Canvas *c, int y, int x, int fg, int attr, const char *s) {
+    for (; *s && x < c->width; s++, x++)
+        canvas_set(c, y, x, (unsigned char)*s, fg, attr);
+}
+
+/* ── ANSI output ─────────────────────────────────────────────────── */
+
+/* Longest escape per cell: cursor move + full SGR + 4-byte glyph */
+#define CELL_MAX_BYTES 32
+
+size_t canvas_diff_max(const Canvas *c) {
+    return (size_t)c->width * (size_t)c->height * CELL_MAX_BYTES + 64;
+}
+
+static size_t put_utf8(char *out, uint32_t cp) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | cp >> 6);
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | cp >> 12);
+        out[1] = (char)(0x80 | (cp >> 6 & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | cp >> 18);
+    out[1] = (char)(0x80 | (cp >> 12 & 0x3F));
+    out[2] = (char)(0x80 | (cp >> 6 & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+static size_t put_style(char *out, int fg, int attr) {
+    size_t n = (size_t)sprintf(out, "\033[0");
+    if (attr & CANVAS_BOLD)
+        n += (size_t)sprintf(out + n, ";1");
+    if (attr & CANVAS_DIM)
+        n += (size_t)sprintf(out + n, ";2");
+    if (attr & CANVAS_REVERSE)
+        n += (size_t)sprintf(out + n, ";7");
+    if (fg != CANVAS_DEFAULT)
+        n += (size_t)sprintf(out + n, ";%d", 30 + fg - 1);
+    out[n++] = 'm';
+    return n;
+}
+
+size_t canvas_diff(const Canvas *prev, const Canvas *cur, char *out) {
+    size_t n = 0;
+    int cy = -1, cx = -1;           /* cursor position, -1 = unknown */
+    int fg = -1, attr = -1;         /* current style, -1 = unknown */
+
+    if (!prev)
+        n += (size_t)sprintf(out, "\033[0m\033[2J");
+
+    for (int y = 0; y < cur->height; y++) {
+        for (int x = 0; x < cur->width; x++) {
+            const CanvasCell *c = &cur->cells[y * cur->width + x];
+            if (prev) {
+                const CanvasCell *p = &prev->cells[y * cur->width + x];
+                if (p->ch == c->ch && p->fg == c->fg && p->attr == c->attr)
+                    continue;
+            } else if (c->ch == ' ' && c->fg == CANVAS_DEFAULT && c->attr == 0) {
+                continue;  /* already blank after the clear */
+            }
+
+            if (y != cy || x != cx)
+                n += (size_t)sprintf(out + n, "\033[%d;%dH", y + 1, x + 1);
+            if (c->fg != fg || c->attr != attr) {
+                n += put_style(out + n, c->fg, c->attr);
+                fg = c->fg;
+                attr = c->attr;
+            }
+            n += put_utf8(out + n, c->ch);
+            cy = y;
+            cx = x + 1;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,63 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Off-screen character grid for drawing without a terminal. Two canvases
+ * can be diffed into the ANSI escape sequences that turn one into the
+ * other, so only changed cells are ever emitted.
+ */
+
+/* Foreground colors: 0 = terminal default, else ANSI color index + 1 */
+#define CANVAS_DEFAULT 0
+#define CANVAS_RED     2
+#define CANVAS_GREEN   3
+#define CANVAS_YELLOW  4
+#define CANVAS_BLUE    5
+#define CANVAS_MAGENTA 6
+#define CANVAS_CYAN    7
+#define CANVAS_WHITE   8
+
+/* Attributes, combinable */
+#define CANVAS_BOLD    1
+#define CANVAS_DIM     2
+#define CANVAS_REVERSE 4
+
+typedef struct {
+    uint32_t      ch;    /* Unicode code point, occupying one column */
+    unsigned char fg;
+    unsigned char attr;
+} CanvasCell;
+
+typedef struct {
+    int         width;
+    int         height;
+    CanvasCell *cells;
+} Canvas;
+
+/* Returns 0 on allocation failure. */
+int    canvas_init(Canvas *c, int width, int height);
+void   canvas_free(Canvas *c);
+
+/* Reset every cell to a default-colored space. */
+void   canvas_clear(Canvas *c);
+
+/* Set one cell; out-of-range positions are ignored. */
+void   canvas_set(Canvas *c, int y, int x, uint32_t ch, int fg, int attr);
+
+/* Write an ASCII string starting at (y, x), clipped at the right edge. */
+void   canvas_text(Canvas *c, int y, int x, int fg, int attr, const char *s);
+
+/* Upper bound on canvas_diff output for a canvas of this size. */
+size_t canvas_diff_max(const Canvas *c);
+
+/*
+ * Append to out the ANSI sequences that redraw prev as cur (same size).
+ * prev = NULL clears the screen and draws everything. Returns bytes
+ * written, 0 if nothing changed.
+ */
+size_t canvas_diff(const Canvas *prev, const Canvas *cur, char *out);
+
+#endif
@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "cast.h"
+#include "canvas.h"
+#include "replay.h"
+#include "game.h"
+#include "layout.h"
+#include "theme.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CAST_WIDTH   LAYOUT_WIDTH
+#define CAST_HEIGHT  LAYOUT_HEIGHT
+
+#define FIELD_Y      LAYOUT_FIELD_Y
+#define LEFT_PANEL_X LAYOUT_LEFT_X
+#define FIELD_X      LAYOUT_FIELD_X
+#define PANEL_X      LAYOUT_PANEL_X
+
+/* Hide the cursor while playing; restore it and the colors at the end */
+#define CAST_START   "\033[?25l"
+#define CAST_END     "\033[0m\033[?25h\r\n"
+
+#define GLYPH_BLOCK  0x2588  /* █ */
+#define GLYPH_SHADE  0x2591  /* ░ */
+#define GLYPH_HINT   0x2592  /* ▒ */
+
+/* Canvas colors are ANSI color index + 1 */
+#define FG(color)    ((color) + 1)
+
+int cast_format_parse(const char *name, CastFormat *out) {
+    if (strcmp(name, "cast") == 0)
+        *out = CAST_ASCIICAST;
+    else if (strcmp(name, "ansi") == 0)
+        *out = CAST_ANSI;
+    else
+        return 0;
+    return 1;
+}
+
+/* ── Drawing ─────────────────────────────────────────────────────── */
+
+/* Foreground for color id (1-7 pieces, 8 garbage), as the color pairs give it */
+static int cell_fg(const Theme *t, int color_id) {
+    return FG(color_id <= 7 ? t->piece[(color_id - 1) % 7] : t->ghost);
+}
+
+static void draw_cell(Canvas *c, int y, int x, const Theme *t, const LayoutCell *cell) {
+    uint32_t glyph = GLYPH_BLOCK;
+    int fg = FG(t->ghost), attr = CANVAS_BOLD;
+    switch (cell->kind) {
+        case LAYOUT_EMPTY:
+            return;
+        case LAYOUT_BLOCK:
+            fg = cell_fg(t, cell->color);
+            break;
+        case LAYOUT_FLASH:
+            fg = cell_fg(t, cell->color);
+            attr = CANVAS_REVERSE | CANVAS_BOLD;
+            break;
+        case LAYOUT_GHOST:
+            glyph = GLYPH_SHADE;
+            attr = CANVAS_DIM;
+            break;
+        case LAYOUT_HINT:
+            glyph = GLYPH_HINT;
+            fg = cell_fg(t, cell->color);
+            attr = 0;
+            break;
+    }
+    canvas_set(c, y, x, glyph, fg, attr);
+    canvas_set(c, y, x + 1, glyph, fg, attr);
+}
+
+static void draw_game(Canvas *c, const Game *g, const Theme *t) {
+    char buf[16];
+    int border = FG(t->border), label = FG(t->label);
+
+    canvas_clear(c);
+
+    /* Border */
+    canvas_set(c, FIELD_Y - 1, FIELD_X - 1, 0x250C, border, 0);
+    canvas_set(c, FIELD_Y - 1, FIELD_X + BOARD_WIDTH * 2, 0x2510, border, 0);
+    canvas_set(c, FIELD_Y + VISIBLE_HEIGHT, FIELD_X - 1, 0x2514, border, 0);
+    canvas_set(c, FIELD_Y + VISIBLE_HEIGHT, FIELD_X + BOARD_WIDTH * 2, 0x2518, border, 0);
+    for (int x = 0; x < BOARD_WIDTH * 2; x++) {
+        canvas_set(c, FIELD_Y - 1, FIELD_X + x, 0x2500, border, 0);
+        canvas_set(c, FIELD_Y + VISIBLE_HEIGHT, FIELD_X + x, 0x2500, border, 0);
+    }
+    for (int r = 0; r < VISIBLE_HEIGHT; r++) {
+        canvas_set(c, FIELD_Y + r, FIELD_X - 1, 0x2502, border, 0);
+        canvas_set(c, FIELD_Y + r, FIELD_X + BOARD_WIDTH * 2, 0x2502, border, 0);
+    }
+
+    /* Playfield, laid out as the terminal shows it */
+    LayoutCell cells[VISIBLE_HEIGHT][BOARD_WIDTH];
+    layout_playfield(g, NULL, cells);
+    for (int r = 0; r < VISIBLE_HEIGHT; r++)
+        for (int col = 0; col < BOARD_WIDTH; col++)
+            draw_cell(c, FIELD_Y + r, FIELD_X + col * 2, t, &cells[r][col]);
+
+    /* Left panel */
+    canvas_text(c, FIELD_Y, LEFT_PANEL_X, label, CANVAS_BOLD, "SCORE:");
+    snprintf(buf, sizeof(buf), "%d", g->score);
+    canvas_text(c, FIELD_Y + 1, LEFT_PANEL_X, label, 0, buf);
+    canvas_text(c, FIELD_Y + 3, LEFT_PANEL_X, label, CANVAS_BOLD, "LINES:");
+    snprintf(buf, sizeof(buf), "%d", g->lines);
+    canvas_text(c, FIELD_Y + 4, LEFT_PANEL_X, label, 0, buf);
+    canvas_text(c, FIELD_Y + 6, LEFT_PANEL_X, label, CANVAS_BOLD, "LEVEL:");
+    snprintf(buf, sizeof(buf), "%d", g->level);
+    canvas_text(c, FIELD_Y + 7, LEFT_PANEL_X, label, 0, buf);
+    canvas_text(c, FIELD_Y + 9, LEFT_PANEL_X, FG(t->legend), CANVAS_DIM, t->name);
+
+    /* Next piece and status */
+    canvas_text(c, FIELD_Y, PANEL_X, label, CANVAS_BOLD, "NEXT:");
+    Piece preview;
+    piece_spawn(&preview, g->next, g->rotation);
+    preview.row = 0;
+    preview.col = 0;
+    int preview_cells[4][2];
+    piece_get_cells(&preview, preview_cells);
+    LayoutCell next = { LAYOUT_BLOCK, (unsigned char)piece_color(g->next) };
+    for (int i = 0; i < 4; i++)
+        draw_cell(c, FIELD_Y + 1 + preview_cells[i][0], PANEL_X + preview_cells[i][1] * 2, t, &next);
+
+    if (g->state == STATE_PAUSED)
+        canvas_text(c, FIELD_Y + 7, PANEL_X, CANVAS_DEFAULT, CANVAS_BOLD, "** PAUSED **");
+    else if (g->state == STATE_GAMEOVER)
+        canvas_text(c, FIELD_Y + 7, PANEL_X, CANVAS_DEFAULT, CANVAS_BOLD, "GAME OVER!");
+}
+
+/* ── Output ──────────────────────────────────────────────────────── */
+
+/* asciicast event: [time, "o", data] with data as a JSON string */
+static void write_event(FILE *f, double seconds, const char *data, size_t len) {
+    fprintf(f, "[%.3f, \"o\", \"", seconds);
+    for (size_t i = 0; i < len; i++) {
+        unsigned char ch = (unsigned char)data[i];
+        if (ch == '"' || ch == '\\')
+            fprintf(f, "\\%c", ch);
+        else if (ch < 0x20)
+            fprintf(f, "\\u%04x", ch);
+        else
+            fputc(ch, f);
+    }
+    fputs("\"]\n", f);
+}
+
+static void emit(FILE *f, CastFormat format, double seconds, const char *data, size_t len) {
+    if (len == 0)
+        return;
+    if (format == CAST_ASCIICAST)
+        write_event(f, seconds, data, len);
+    else
+        fwrite(data, 1, len, f);
+}
+
+int cast_run(const CastOptions *opt) {
+    ReplayReader replay;
+    if (!replay_open(&replay, opt->replay_path)) {
+        fprintf(stderr, "termv: %s is not a termv replay\n", opt->replay_path);
+        return 1;
+    }
+    FILE *out = fopen(opt->out_path, "wb");
+    if (!out) {
+        perror(opt->out_path);
+        replay_free(&replay);
+        return 1;
+    }
+
+    Canvas canvas[2];
+    char *diff = NULL;
+    int ok = canvas_init(&canvas[0], CAST_WIDTH, CAST_HEIGHT)
+          && canvas_init(&canvas[1], CAST_WIDTH, CAST_HEIGHT)
+          && (diff = malloc(canvas_diff_max(&canvas[0]))) != NULL;
+    if (!ok) {
+        fprintf(stderr, "termv: out of memory\n");
+        fclose(out);
+        replay_free(&replay);
+        return 1;
+    }
+
+    Game game;
+    replay_start(&replay, &game);
+
+    if (opt->format == CAST_ASCIICAST)
+        fprintf(out, "{\"version\": 2, \"width\": %d, \"height\": %d, \"title\": \"termv seed %u\"}\n",
+                CAST_WIDTH, CAST_HEIGHT, replay.seed);
+    emit(out, opt->format, 0.0, CAST_START, sizeof(CAST_START) - 1);
+
+    double started = util_now_seconds();
+    double period = 1000.0 / opt->fps;
+    double game_ms = 0.0, next_sample = 0.0;
+    unsigned long long samples = 0, frames = 0;
+    int cur = 0;
+
+    /* Frame 0 draws everything; later frames only what changed */
+    draw_game(&canvas[cur], &game, theme_get(replay.theme_cycles));
+    emit(out, opt->format, 0.0, diff, canvas_diff(NULL, &canvas[cur], diff));
+    frames++;
+    next_sample = period;
+
+    unsigned dt;
+    while ((dt = replay_advance(&replay, &game)) > 0) {
+        game_ms += dt;
+        if (game_ms < next_sample)
+            continue;
+
+        /* Sample on the grid of periods; a long step skips samples */
+        while (next_sample <= game_ms)
+            next_sample += period;
+        samples++;
+        int nxt = cur ^ 1;
+        draw_game(&canvas[nxt], &game, theme_get(replay.theme_cycles));
+        size_t len = canvas_diff(&canvas[cur], &canvas[nxt], diff);
+        if (len > 0) {
+            emit(out, opt->format, game_ms / 1000.0, diff, len);
+            frames++;
+            cur = nxt;
+        }
+    }
+
+    emit(out, opt->format, game_ms / 1000.0, CAST_END, sizeof(CAST_END) - 1);
+    double elapsed = util_now_seconds() - started;
+    int failed = ferror(out) != 0;
+    failed |= fclose(out) != 0;
+
+    canvas_free(&canvas[0]);
+    canvas_free(&canvas[1]);
+    free(diff);
+    replay_free(&replay);
+
+    if (failed) {
+        perror(opt->out_path);
+        return 1;
+    }
+    printf("%llu frames (%llu sampled) covering %.1f s of play in %.3f s (%.0f frames/s)\n",
+           frames, samples + 1, game_ms / 1000.0, elapsed,
+           elapsed > 0.0 ? (samples + 1) / elapsed : 0.0);
+    printf("Final score %d, %d lines\n", game.score, game.lines);
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef CAST_H
+#define CAST_H
+
+/*
+ * Offline replay rendering (`termv --render-replay IN OUT`). The game is
+ * rerun from the recording as fast as the CPU allows, drawn off-screen in
+ * the same layout as the terminal frontend, and sampled at a fixed rate of
+ * game time. Each sample is diffed against the previous one and only the
+ * changed cells are written, as an asciicast v2 recording (for asciinema
+ * players) or as one raw ANSI stream.
+ */
+
+typedef enum {
+    CAST_ASCIICAST,
+    CAST_ANSI
+} CastFormat;
+
+typedef struct {
+    const char *replay_path;
+    const char *out_path;
+    CastFormat  format;
+    int         fps;      /* samples per second of game time */
+} CastOptions;
+
+/* Parse "cast" / "ansi". Returns 0 if unknown. */
+int cast_format_parse(const char *name, CastFormat *out);
+
+/* Render and print a summary to stdout. Returns a process exit status. */
+int cast_run(const CastOptions *opt);
+
+#endif
@@ -0,0 +1,622 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "corpus.h"
+#include "replay.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CORPUS_MAGIC   0x31435654u  /* "TVC1" */
+#define CORPUS_VERSION 1
+#define CHUNK_ROWS     4096         /* rows per filter pass */
+#define LEVEL_BUCKETS  256          /* higher levels share the last bucket */
+
+/* 32-bit columns, in file order */
+enum {
+    COL_SEED,
+    COL_SCORE,
+    COL_LINES,
+    COL_LEVEL,
+    COL_DURATION,    /* ms of running play */
+    COL_PIECES,
+    COL_SINGLES,
+    COL_DOUBLES,
+    COL_TRIPLES,
+    COL_TETRISES,
+    COL_HEIGHT,      /* tallest stack */
+    COL_STREAM_LEN,  /* bytes in DB.streams */
+    COL_COUNT
+};
+
+static const char *const COLUMN_NAMES[COL_COUNT] = {
+    "seed", "score", "lines", "level", "duration", "pieces",
+    "singles", "doubles", "triples", "tetrises", "height", "stream_len"
+};
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t rows;
+    uint64_t streams_end;  /* bytes of DB.streams in use */
+    uint8_t  pad[40];
+} CorpusHeader;
+
+/*
+ * File layout: header, then COL_COUNT arrays of rows uint32, then rows
+ * uint64 stream offsets (8-aligned: the header is 64 bytes and COL_COUNT
+ * is even).
+ */
+typedef struct {
+    void           *map;
+    size_t          size;
+    uint64_t        rows;
+    uint64_t        streams_end;
+    const uint32_t *col[COL_COUNT];
+    const uint64_t *offset;
+} Corpus;
+
+static size_t corpus_size(uint64_t rows) {
+    return sizeof(CorpusHeader) + (size_t)rows * (COL_COUNT * sizeof(uint32_t) + sizeof(uint64_t));
+}
+
+static void corpus_columns(Corpus *c, const unsigned char *base) {
+    const unsigned char *p = base + sizeof(CorpusHeader);
+    for (int i = 0; i < COL_COUNT; i++) {
+        c->col[i] = (const uint32_t *)p;
+        p += c->rows * sizeof(uint32_t);
+    }
+    c->offset = (const uint64_t *)p;
+}
+
+/* Map DB read-only. A missing file is an empty corpus if missing_ok. */
+static int corpus_open(Corpus *c, const char *path, int missing_ok) {
+    memset(c, 0, sizeof(*c));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT && missing_ok)
+            return 1;
+        perror(path);
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CorpusHeader)) {
+        fprintf(stderr, "termv: %s is not a replay corpus\n", path);
+        close(fd);
+        return 0;
+    }
+    c->size = (size_t)st.st_size;
+    c->map = mmap(NULL, c->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (c->map == MAP_FAILED) {
+        c->map = NULL;
+        perror(path);
+        return 0;
+    }
+
+    const CorpusHeader *h = c->map;
+    if (h->magic != CORPUS_MAGIC || h->version != CORPUS_VERSION
+        || corpus_size(h->rows) != c->size) {
+        fprintf(stderr, "termv: %s is not a replay corpus\n", path);
+        munmap(c->map, c->size);
+        c->map = NULL;
+        return 0;
+    }
+    c->rows = h->rows;
+    c->streams_end = h->streams_end;
+    corpus_columns(c, c->map);
+    return 1;
+}
+
+static void corpus_close(Corpus *c) {
+    if (c->map)
+        munmap(c->map, c->size);
+    c->map = NULL;
+}
+
+/* ── Threads ─────────────────────────────────────────────────────── */
+
+/* Run fn on each of n task structs of the given size; task 0 on this thread. */
+static void run_tasks(void *(*fn)(void *), void *tasks, size_t size, int n) {
+    pthread_t tids[UTIL_MAX_THREADS];
+    int started[UTIL_MAX_THREADS] = { 0 };
+
+    for (int i = 1; i < n; i++)
+        started[i] = pthread_create(&tids[i], NULL, fn, (char *)tasks + (size_t)i * size) == 0;
+    fn(tasks);
+    for (int i = 1; i < n; i++) {
+        if (started[i])
+            pthread_join(tids[i], NULL);
+        else
+            fn((char *)tasks + (size_t)i * size);  /* could not spawn: run it here */
+    }
+}
+
+/* ── Ingest ──────────────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t col[COL_COUNT];
+    uint64_t offset;
+    int      ok;
+} Summary;
+
+typedef struct {
+    char *const *paths;
+    int          count;
+    int          next;     /* next path to take */
+    int          streams;  /* DB.streams descriptor */
+    uint64_t     tail;     /* end of DB.streams */
+    Summary     *out;
+} IngestJob;
+
+static void summarize(const char *path, IngestJob *job, Summary *s) {
+    ReplayReader r;
+    s->ok = 0;
+    if (!replay_open(&r, path)) {
+        fprintf(stderr, "termv: skipping %s: not a termv replay\n", path);
+        return;
+    }
+
+    Game g;
+    replay_start(&r, &g);
+    while (replay_advance(&r, &g) > 0)
+        ;
+
+    s->col[COL_SEED] = r.seed;
+    s->col[COL_SCORE] = (uint32_t)g.score;
+    s->col[COL_LINES] = (uint32_t)g.lines;
+    s->col[COL_LEVEL] = (uint32_t)g.level;
+    s->col[COL_DURATION] = (uint32_t)g.stats.time_ms;
+    s->col[COL_PIECES] = g.stats.pieces;
+    s->col[COL_SINGLES] = g.stats.clears[0];
+    s->col[COL_DOUBLES] = g.stats.clears[1];
+    s->col[COL_TRIPLES] = g.stats.clears[2];
+    s->col[COL_TETRISES] = g.stats.clears[3];
+    s->col[COL_HEIGHT] = (uint32_t)g.stats.max_height;
+    s->col[COL_STREAM_LEN] = (uint32_t)r.len;
+
+    /* Reserve a range of the streams file, then fill it */
+    s->offset = __atomic_fetch_add(&job->tail, (uint64_t)r.len, __ATOMIC_RELAXED);
+    size_t done = 0;
+    while (done < r.len) {
+        ssize_t n = pwrite(job->streams, r.data + done, r.len - done, (off_t)(s->offset + done));
+        if (n <= 0) {
+            perror(path);
+            replay_free(&r);
+            return;
+        }
+        done += (size_t)n;
+    }
+    replay_free(&r);
+    s->ok = 1;
+}
+
+static void *ingest_main(void *arg) {
+    IngestJob *job = *(IngestJob **)arg;
+    for (;;) {
+        int i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (i >= job->count)
+            break;
+        summarize(job->paths[i], job, &job->out[i]);
+    }
+    return NULL;
+}
+
+/* Write old rows plus the new summaries to path. Returns rows written, or -1. */
+static int64_t write_corpus(const char *path, const Corpus *old, const Summary *add, int n,
+                            uint64_t streams_end) {
+    uint64_t added = 0;
+    for (int i = 0; i < n; i++)
+        added += add[i].ok != 0;
+
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return -1;
+    CorpusHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = CORPUS_MAGIC;
+    h.version = CORPUS_VERSION;
+    h.rows = old->rows + added;
+    h.streams_end = streams_end;
+    fwrite(&h, sizeof(h), 1, f);
+
+    for (int c = 0; c < COL_COUNT; c++) {
+        if (old->rows > 0)
+            fwrite(old->col[c], sizeof(uint32_t), (size_t)old->rows, f);
+        for (int i = 0; i < n; i++) {
+            if (add[i].ok)
+                fwrite(&add[i].col[c], sizeof(uint32_t), 1, f);
+        }
+    }
+    if (old->rows > 0)
+        fwrite(old->offset, sizeof(uint64_t), (size_t)old->rows, f);
+    for (int i = 0; i < n; i++) {
+        if (add[i].ok)
+            fwrite(&add[i].offset, sizeof(uint64_t), 1, f);
+    }
+
+    int failed = ferror(f) != 0;
+    failed |= fflush(f) != 0 || fsync(fileno(f)) != 0;
+    failed |= fclose(f) != 0;
+    return failed ? -1 : (int64_t)h.rows;
+}
+
+static int corpus_add(const CorpusOptions *opt) {
+    char streams_path[512], tmp_path[512];
+    snprintf(streams_path, sizeof(streams_path), "%s.streams", opt->db_path);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%ld", opt->db_path, (long)getpid());
+
+    /* One add at a time: the lock on DB.streams is held from reading DB
+     * until the new DB is renamed into place */
+    IngestJob job = { opt->replays, opt->replay_count, 0, -1, 0, NULL };
+    job.streams = open(streams_path, O_RDWR | O_CREAT, 0644);
+    if (job.streams < 0 || flock(job.streams, LOCK_EX) != 0) {
+        perror(streams_path);
+        if (job.streams >= 0)
+            close(job.streams);
+        return 1;
+    }
+
+    Corpus old;
+    if (!corpus_open(&old, opt->db_path, 1)) {
+        close(job.streams);
+        return 1;
+    }
+
+    job.out = calloc((size_t)(opt->replay_count > 0 ? opt->replay_count : 1), sizeof(*job.out));
+    struct stat st;
+    if (!job.out || fstat(job.streams, &st) != 0) {
+        perror(streams_path);
+        close(job.streams);
+        free(job.out);
+        corpus_close(&old);
+        return 1;
+    }
+    /* Streams past the recorded end belong to an interrupted add: reuse the space */
+    job.tail = old.streams_end;
+    if ((uint64_t)st.st_size < job.tail) {
+        fprintf(stderr, "termv: %s is shorter than its index\n", streams_path);
+        close(job.streams);
+        free(job.out);
+        corpus_close(&old);
+        return 1;
+    }
+
+    int threads = util_thread_count(opt->threads);
+    if (threads > opt->replay_count)
+        threads = opt->replay_count > 0 ? opt->replay_count : 1;
+    IngestJob *tasks[UTIL_MAX_THREADS];
+    for (int i = 0; i < threads; i++)
+        tasks[i] = &job;
+
+    double started = util_now_seconds();
+    run_tasks(ingest_main, tasks, sizeof(tasks[0]), threads);
+    int ok = fsync(job.streams) == 0;
+
+    int64_t rows = ok ? write_corpus(tmp_path, &old, job.out, opt->replay_count, job.tail) : -1;
+    uint64_t before = old.rows;
+    corpus_close(&old);
+    if (rows < 0 || rename(tmp_path, opt->db_path) != 0) {
+        perror(opt->db_path);
+        unlink(tmp_path);
+        close(job.streams);
+        free(job.out);
+        return 1;
+    }
+    close(job.streams);
+    free(job.out);
+
+    uint64_t added = (uint64_t)rows - before;
+    printf("added %llu of %d replays in %.3f s (%d thread%s), corpus now %lld games\n",
+           (unsigned long long)added, opt->replay_count, util_now_seconds() - started,
+           threads, threads == 1 ? "" : "s", (long long)rows);
+    return added == (uint64_t)opt->replay_count ? 0 : 1;
+}
+
+/* ── Filter queries ──────────────────────────────────────────────── */
+
+enum { OP_LT, OP_LE, OP_GT, OP_GE, OP_EQ, OP_NE };
+
+#define MAX_TERMS 16
+
+typedef struct {
+    int      col;
+    int      op;
+    uint32_t value;
+} Term;
+
+/* Parse "name op value[,name op value...]". Returns the term count, -1 on error. */
+static int parse_filter(const char *s, Term *terms) {
+    int n = 0;
+    while (*s) {
+        if (n == MAX_TERMS)
+            return -1;
+        char name[16];
+        int len = 0;
+        while (isalpha((unsigned char)*s) || *s == '_') {
+            if (len + 1 < (int)sizeof(name))
+                name[len++] = *s;
+            s++;
+        }
+        name[len] = '\0';
+        terms[n].col = -1;
+        for (int c = 0; c < COL_COUNT; c++) {
+            if (strcmp(name, COLUMN_NAMES[c]) == 0)
+                terms[n].col = c;
+        }
+        if (terms[n].col < 0)
+            return -1;
+
+        if (s[0] == '<' && s[1] == '=')       { terms[n].op = OP_LE; s += 2; }
+        else if (s[0] == '>' && s[1] == '=')  { terms[n].op = OP_GE; s += 2; }
+        else if (s[0] == '!' && s[1] == '=')  { terms[n].op = OP_NE; s += 2; }
+        else if (s[0] == '<')                 { terms[n].op = OP_LT; s++; }
+        else if (s[0] == '>')                 { terms[n].op = OP_GT; s++; }
+        else if (s[0] == '=')                 { terms[n].op = OP_EQ; s += s[1] == '=' ? 2 : 1; }
+        else return -1;
+
+        /* Columns are uint32: no sign, nothing wider */
+        if (!isdigit((unsigned char)*s))
+            return -1;
+        char *end;
+        errno = 0;
+        unsigned long v = strtoul(s, &end, 10);
+        if (errno == ERANGE || v > UINT32_MAX)
+            return -1;
+        terms[n++].value = (uint32_t)v;
+        s = end;
+        if (*s == ',')
+            s++;
+        else if (*s)
+            return -1;
+    }
+    return n;
+}
+
+typedef struct {
+    const Corpus *c;
+    const Term   *terms;
+    int           term_count;
+    uint64_t      begin, end;
+    uint64_t      matches;
+    uint64_t     *first;       /* up to limit matching rows, in order */
+    int           first_count;
+    int           limit;
+} QueryTask;
+
+/* AND one term into mask[0..n-1]; each op is its own loop so it vectorizes */
+static void apply_term(const Term *t, const uint32_t *v, unsigned char *mask, int n) {
+    uint32_t x = t->value;
+    switch (t->op) {
+        case OP_LT: for (int i = 0; i < n; i++) mask[i] &= v[i] <  x; break;
+        case OP_LE: for (int i = 0; i < n; i++) mask[i] &= v[i] <= x; break;
+        case OP_GT: for (int i = 0; i < n; i++) mask[i] &= v[i] >  x; break;
+        case OP_GE: for (int i = 0; i < n; i++) mask[i] &= v[i] >= x; break;
+        case OP_EQ: for (int i = 0; i < n; i++) mask[i] &= v[i] == x; break;
+        default:    for (int i = 0; i < n; i++) mask[i] &= v[i] != x; break;
+    }
+}
+
+static void *query_main(void *arg) {
+    QueryTask *q = arg;
+    unsigned char mask[CHUNK_ROWS];
+
+    for (uint64_t row = q->begin; row < q->end; row += CHUNK_ROWS) {
+        int n = q->end - row < CHUNK_ROWS ? (int)(q->end - row) : CHUNK_ROWS;
+        memset(mask, 1, (size_t)n);
+        for (int t = 0; t < q->term_count; t++)
+            apply_term(&q->terms[t], q->c->col[q->terms[t].col] + row, mask, n);
+
+        for (int i = 0; i < n; i++) {
+            q->matches += mask[i];
+            if (mask[i] && q->first_count < q->limit)
+                q->first[q->first_count++] = row + (uint64_t)i;
+        }
+    }
+    return NULL;
+}
+
+static int corpus_query(const CorpusOptions *opt) {
+    Term terms[MAX_TERMS];
+    int term_count = parse_filter(opt->filter ? opt->filter : "", terms);
+    if (term_count < 0) {
+        fprintf(stderr, "termv: bad filter '%s' (columns:", opt->filter);
+        for (int c = 0; c < COL_COUNT; c++)
+            fprintf(stderr, " %s", COLUMN_NAMES[c]);
+        fprintf(stderr, "; operators: < <= > >= = !=)\n");
+        return 1;
+    }
+
+    Corpus c;
+    if (!corpus_open(&c, opt->db_path, 0))
+        return 1;
+
+    int threads = util_thread_count(opt->threads);
+    int limit = opt->limit > 0 ? opt->limit : 0;
+    QueryTask tasks[UTIL_MAX_THREADS];
+    uint64_t *first = malloc((size_t)threads * (size_t)(limit > 0 ? limit : 1) * sizeof(*first));
+    if (!first) {
+        fprintf(stderr, "termv: out of memory\n");
+        corpus_close(&c);
+        return 1;
+    }
+    for (int i = 0; i < threads; i++) {
+        tasks[i] = (QueryTask){ &c, terms, term_count,
+                                c.rows * (uint64_t)i / (uint64_t)threads,
+                                c.rows * (uint64_t)(i + 1) / (uint64_t)threads,
+                                0, first + (size_t)i * (size_t)limit, 0, limit };
+    }
+
+    double started = util_now_seconds();
+    run_tasks(query_main, tasks, sizeof(tasks[0]), threads);
+    double elapsed = util_now_seconds() - started;
+
+    uint64_t matches = 0;
+    for (int i = 0; i < threads; i++)
+        matches += tasks[i].matches;
+    printf("%llu of %llu games match \"%s\" (%.3f ms, %d thread%s)\n",
+           (unsigned long long)matches, (unsigned long long)c.rows,
+           opt->filter ? opt->filter : "", elapsed * 1000.0, threads, threads == 1 ? "" : "s");
+
+    /* Threads cover rows in order, so their lists concatenate in row order */
+    int shown = 0;
+    for (int i = 0; i < threads && shown < limit; i++) {
+        for (int j = 0; j < tasks[i].first_count && shown < limit; j++, shown++) {
+            uint64_t r = tasks[i].first[j];
+            if (shown == 0)
+                printf("%10s %10s %10s %6s %5s %8s %8s %12s\n", "row", "seed", "score",
+                       "lines", "level", "time_s", "tetrises", "stream");
+            printf("%10llu %10u %10u %6u %5u %8.1f %8u %12llu\n", (unsigned long long)r,
+                   c.col[COL_SEED][r], c.col[COL_SCORE][r], c.col[COL_LINES][r],
+                   c.col[COL_LEVEL][r], c.col[COL_DURATION][r] / 1000.0,
+                   c.col[COL_TETRISES][r], (unsigned long long)c.offset[r]);
+        }
+    }
+
+    free(first);
+    corpus_close(&c);
+    return 0;
+}
+
+/* ── Score percentiles per level ─────────────────────────────────── */
+
+typedef struct {
+    const Corpus *c;
+    uint64_t      begin, end;
+    uint64_t      count[LEVEL_BUCKETS];  /* pass 1: rows per level; pass 2: write cursor */
+    uint32_t     *scores;                /* scores grouped by level */
+    const uint64_t *level_start;
+    int          *next_level;            /* sort pass: next level to take */
+} LevelTask;
+
+static int level_bucket(uint32_t level) {
+    return level < LEVEL_BUCKETS ? (int)level : LEVEL_BUCKETS - 1;
+}
+
+static void *level_count_main(void *arg) {
+    LevelTask *t = arg;
+    const uint32_t *level = t->c->col[COL_LEVEL];
+    for (uint64_t r = t->begin; r < t->end; r++)
+        t->count[level_bucket(level[r])]++;
+    return NULL;
+}
+
+static void *level_scatter_main(void *arg) {
+    LevelTask *t = arg;
+    const uint32_t *level = t->c->col[COL_LEVEL];
+    const uint32_t *score = t->c->col[COL_SCORE];
+    for (uint64_t r = t->begin; r < t->end; r++)
+        t->scores[t->count[level_bucket(level[r])]++] = score[r];
+    return NULL;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void *level_sort_main(void *arg) {
+    LevelTask *t = arg;
+    for (;;) {
+        int l = __atomic_fetch_add(t->next_level, 1, __ATOMIC_RELAXED);
+        if (l >= LEVEL_BUCKETS)
+            break;
+        uint64_t n = t->level_start[l + 1] - t->level_start[l];
+        if (n > 1)
+            qsort(t->scores + t->level_start[l], (size_t)n, sizeof(uint32_t), compare_u32);
+    }
+    return NULL;
+}
+
+/* Nearest-rank percentile of a sorted run */
+static uint32_t percentile(const uint32_t *sorted, uint64_t n, int pct) {
+    uint64_t rank = (n * (uint64_t)pct + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static int corpus_levels(const CorpusOptions *opt) {
+    Corpus c;
+    if (!corpus_open(&c, opt->db_path, 0))
+        return 1;
+
+    int threads = util_thread_count(opt->threads);
+    LevelTask *tasks = calloc((size_t)threads, sizeof(*tasks));
+    uint64_t *level_start = calloc(LEVEL_BUCKETS + 1, sizeof(*level_start));
+    uint32_t *scores = malloc((size_t)(c.rows > 0 ? c.rows : 1) * sizeof(*scores));
+    if (!tasks || !level_start || !scores) {
+        fprintf(stderr, "termv: out of memory\n");
+        free(tasks);
+        free(level_start);
+        free(scores);
+        corpus_close(&c);
+        return 1;
+    }
+
+    double started = util_now_seconds();
+    int next_level = 0;
+    for (int i = 0; i < threads; i++) {
+        tasks[i].c = &c;
+        tasks[i].begin = c.rows * (uint64_t)i / (uint64_t)threads;
+        tasks[i].end = c.rows * (uint64_t)(i + 1) / (uint64_t)threads;
+        tasks[i].scores = scores;
+        tasks[i].level_start = level_start;
+        tasks[i].next_level = &next_level;
+    }
+    run_tasks(level_count_main, tasks, sizeof(*tasks), threads);
+
+    /* Level-major, then thread order: each thread scatters into its own slice */
+    uint64_t pos = 0;
+    for (int l = 0; l < LEVEL_BUCKETS; l++) {
+        level_start[l] = pos;
+        for (int i = 0; i < threads; i++) {
+            uint64_t n = tasks[i].count[l];
+            tasks[i].count[l] = pos;
+            pos += n;
+        }
+    }
+    level_start[LEVEL_BUCKETS] = pos;
+    run_tasks(level_scatter_main, tasks, sizeof(*tasks), threads);
+    run_tasks(level_sort_main, tasks, sizeof(*tasks), threads);
+    double elapsed = util_now_seconds() - started;
+
+    printf("%5s %10s %10s %10s %10s %10s\n", "level", "games", "p50", "p90", "p99", "max");
+    for (int l = 0; l < LEVEL_BUCKETS; l++) {
+        uint64_t n = level_start[l + 1] - level_start[l];
+        if (n == 0)
+            continue;
+        const uint32_t *s = scores + level_start[l];
+        printf("%4d%s %10llu %10u %10u %10u %10u\n", l, l == LEVEL_BUCKETS - 1 ? "+" : " ",
+               (unsigned long long)n, percentile(s, n, 50), percentile(s, n, 90),
+               percentile(s, n, 99), s[n - 1]);
+    }
+    printf("%llu games in %.3f ms (%d thread%s)\n", (unsigned long long)c.rows,
+           elapsed * 1000.0, threads, threads == 1 ? "" : "s");
+
+    free(tasks);
+    free(level_start);
+    free(scores);
+    corpus_close(&c);
+    return 0;
+}
+
+/* ── Entry point ─────────────────────────────────────────────────── */
+
+int corpus_run(const CorpusOptions *opt) {
+    switch (opt->mode) {
+        case CORPUS_ADD:
+            return corpus_add(opt);
+        case CORPUS_QUERY:
+            return corpus_query(opt);
+        default:
+            return corpus_levels(opt);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+/*
+ * Replay corpus: summaries of many recorded games, queryable without
+ * re-simulating them.
+ *
+ *   DB          memory-mapped column store. Each summary field is one
+ *               contiguous array with a row per game, so a query touches
+ *               only the columns it tests. Host byte order.
+ *   DB.streams  append-only copies of the raw replays; each row holds the
+ *               offset and length of its game's stream
+ *
+ * Adding games simulates each replay once (in parallel), appends the
+ * streams, and rewrites DB through a temporary file and rename(), so
+ * readers always see a complete table. Queries split the rows across
+ * threads.
+ */
+
+typedef enum {
+    CORPUS_ADD,     /* ingest replay files */
+    CORPUS_QUERY,   /* count and list the games matching a filter */
+    CORPUS_LEVELS   /* score percentiles per level */
+} CorpusMode;
+
+typedef struct {
+    CorpusMode   mode;
+    const char  *db_path;
+    char *const *replays;     /* CORPUS_ADD */
+    int          replay_count;
+    const char  *filter;      /* CORPUS_QUERY: e.g. "tetrises>30,level>=10" */
+    int          limit;       /* CORPUS_QUERY: matches to list */
+    int          threads;     /* 0 = one per online CPU */
+} CorpusOptions;
+
+/* Run and print the report to stdout. Returns a process exit status. */
+int corpus_run(const CorpusOptions *opt);
+
+#endif
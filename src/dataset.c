@@ -0,0 +1,271 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "dataset.h"
+#include "replay.h"
+#include "input.h"
+#include "game.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define CHUNK_SAMPLES 4096   /* samples buffered per thread before a write */
+#define NPY_HEADER    128    /* magic, version, length and padded dict; 64-aligned */
+
+/* ── Arrays ──────────────────────────────────────────────────────── */
+
+enum {
+    ARRAY_BOARDS,
+    ARRAY_PIECES,
+    ARRAY_PLACEMENTS,
+    ARRAY_REWARDS,
+    ARRAY_GAMES,
+    ARRAY_COUNT
+};
+
+typedef struct {
+    const char *file;
+    const char *type;   /* .npy descr without the byte order */
+    size_t      item;   /* bytes per element */
+    const char *dims;   /* shape after N */
+    size_t      row;    /* bytes per sample */
+} ArraySpec;
+
+static const ArraySpec ARRAYS[ARRAY_COUNT] = {
+    { "boards.npy",     "u1", 1, ", 20, 10", VISIBLE_HEIGHT * BOARD_WIDTH },
+    { "pieces.npy",     "u1", 1, ", 2",      2 },
+    { "placements.npy", "i1", 1, ", 3",      3 },
+    { "rewards.npy",    "i4", 4, ", 2",      2 * sizeof(int32_t) },
+    { "games.npy",      "u4", 4, ",",        sizeof(uint32_t) },
+};
+
+/* Samples in host byte order, one buffer per array */
+typedef struct {
+    uint8_t  boards[CHUNK_SAMPLES][VISIBLE_HEIGHT][BOARD_WIDTH];
+    uint8_t  pieces[CHUNK_SAMPLES][2];
+    int8_t   placements[CHUNK_SAMPLES][3];
+    int32_t  rewards[CHUNK_SAMPLES][2];
+    uint32_t games[CHUNK_SAMPLES];
+    int      count;
+} Chunk;
+
+static const void *chunk_array(const Chunk *c, int a) {
+    switch (a) {
+        case ARRAY_BOARDS:     return c->boards;
+        case ARRAY_PIECES:     return c->pieces;
+        case ARRAY_PLACEMENTS: return c->placements;
+        case ARRAY_REWARDS:    return c->rewards;
+        default:               return c->games;
+    }
+}
+
+/* Write the .npy header for rows samples; rewritten once the count is known. */
+static int write_header(int fd, const ArraySpec *a, uint64_t rows) {
+    static const uint16_t probe = 1;
+    char order = a->item == 1 ? '|' : *(const unsigned char *)&probe ? '<' : '>';
+    char h[NPY_HEADER];
+
+    memset(h, ' ', sizeof(h));
+    memcpy(h, "\x93NUMPY\x01\x00", 8);
+    h[8] = (char)((NPY_HEADER - 10) & 0xff);
+    h[9] = (char)((NPY_HEADER - 10) >> 8);
+    int n = snprintf(h + 10, NPY_HEADER - 10,
+                     "{'descr': '%c%s', 'fortran_order': False, 'shape': (%llu%s), }",
+                     order, a->type, (unsigned long long)rows, a->dims);
+    if (n < 0 || n >= NPY_HEADER - 11)
+        return 0;
+    h[10 + n] = ' ';
+    h[NPY_HEADER - 1] = '\n';
+    return pwrite(fd, h, NPY_HEADER, 0) == NPY_HEADER;
+}
+
+/* ── Export ──────────────────────────────────────────────────────── */
+
+typedef struct {
+    char *const *paths;
+    int          count;
+    int          next;                /* next replay to take */
+    int          fds[ARRAY_COUNT];
+    uint64_t     rows;                /* rows reserved so far */
+    int          exported;            /* replays read */
+    int          failed;              /* a write failed */
+} ExportJob;
+
+static int write_all(int fd, const void *buf, size_t len, off_t at) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, at);
+        if (n <= 0)
+            return 0;
+        p += n;
+        len -= (size_t)n;
+        at += n;
+    }
+    return 1;
+}
+
+/* Reserve rows for the chunk and write each array's slice in place. */
+static void flush_chunk(ExportJob *job, Chunk *c) {
+    if (c->count == 0)
+        return;
+    uint64_t first = __atomic_fetch_add(&job->rows, (uint64_t)c->count, __ATOMIC_RELAXED);
+    for (int a = 0; a < ARRAY_COUNT; a++) {
+        off_t at = (off_t)(NPY_HEADER + first * ARRAYS[a].row);
+        if (!write_all(job->fds[a], chunk_array(c, a), (size_t)c->count * ARRAYS[a].row, at))
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+    }
+    c->count = 0;
+}
+
+/*
+ * Replay one game a record at a time, taking a sample whenever a piece
+ * locks. Nothing moves a piece and locks it in the same record except a
+ * hard drop, so the locked spot is the piece's last position dropped to
+ * its ghost row.
+ */
+static void export_replay(ExportJob *job, Chunk *c, int index) {
+    const char *path = job->paths[index];
+    ReplayReader r;
+    if (!replay_open(&r, path)) {
+        fprintf(stderr, "termv: skipping %s: not a termv replay\n", path);
+        return;
+    }
+
+    Game g;
+    replay_start(&r, &g);
+    Board before = g.board;
+    PieceType next = g.next;
+    uint32_t pieces = g.stats.pieces;
+    int score = g.score, lines = g.lines;
+
+    InputAction action;
+    unsigned dt;
+    while (g.state != STATE_QUIT && replay_next(&r, &action, &dt)) {
+        Piece moving = g.current;
+        if (action == ACTION_NONE)
+            game_update(&g, dt);
+        else
+            input_handle(&g, action);
+        if (g.stats.pieces == pieces)
+            continue;
+
+        int i = c->count++;
+        for (int row = 0; row < VISIBLE_HEIGHT; row++) {
+            unsigned bits = board_row_bits(&before, HIDDEN_HEIGHT + row);
+            for (int col = 0; col < BOARD_WIDTH; col++)
+                c->boards[i][row][col] = (uint8_t)(bits >> col & 1);
+        }
+        c->pieces[i][0] = (uint8_t)moving.type;
+        c->pieces[i][1] = (uint8_t)next;
+        c->placements[i][0] = (int8_t)moving.rotation;
+        c->placements[i][1] = (int8_t)piece_ghost_row(&before, &moving);
+        c->placements[i][2] = (int8_t)moving.col;
+        c->rewards[i][0] = g.score - score;
+        c->rewards[i][1] = g.lines - lines;
+        c->games[i] = (uint32_t)index;
+        if (c->count == CHUNK_SAMPLES)
+            flush_chunk(job, c);
+
+        before = g.board;
+        next = g.next;
+        pieces = g.stats.pieces;
+        score = g.score;
+        lines = g.lines;
+    }
+    replay_free(&r);
+    __atomic_fetch_add(&job->exported, 1, __ATOMIC_RELAXED);
+}
+
+static void *export_main(void *arg) {
+    ExportJob *job = arg;
+    Chunk *c = malloc(sizeof(*c));
+    if (!c) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    c->count = 0;
+    for (;;) {
+        int i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (i >= job->count)
+            break;
+        export_replay(job, c, i);
+    }
+    flush_chunk(job, c);
+    free(c);
+    return NULL;
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+int dataset_run(const DatasetOptions *opt) {
+    if (opt->replay_count == 0) {
+        fprintf(stderr, "termv: --export-dataset needs at least one replay\n");
+        return 1;
+    }
+    if (mkdir(opt->out_dir, 0755) != 0 && errno != EEXIST) {
+        perror(opt->out_dir);
+        return 1;
+    }
+
+    ExportJob job;
+    memset(&job, 0, sizeof(job));
+    job.paths = opt->replays;
+    job.count = opt->replay_count;
+
+    char paths[ARRAY_COUNT][512];
+    int ok = 1;
+    for (int a = 0; a < ARRAY_COUNT; a++)
+        job.fds[a] = -1;
+    for (int a = 0; ok && a < ARRAY_COUNT; a++) {
+        snprintf(paths[a], sizeof(paths[a]), "%s/%s", opt->out_dir, ARRAYS[a].file);
+        job.fds[a] = open(paths[a], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ok = job.fds[a] >= 0 && write_header(job.fds[a], &ARRAYS[a], 0);
+        if (!ok)
+            perror(paths[a]);
+    }
+
+    int threads = util_thread_count(opt->threads);
+    if (threads > opt->replay_count)
+        threads = opt->replay_count;
+
+    double started = util_now_seconds();
+    if (ok) {
+        pthread_t tids[UTIL_MAX_THREADS];
+        int spawned = 1;
+        for (; spawned < threads; spawned++) {
+            if (pthread_create(&tids[spawned], NULL, export_main, &job) != 0)
+                break;
+        }
+        export_main(&job);
+        for (int i = 1; i < spawned; i++)
+            pthread_join(tids[i], NULL);
+        ok = !job.failed;
+    }
+
+    /* Now that N is known, finish the headers */
+    uint64_t bytes = 0;
+    for (int a = 0; a < ARRAY_COUNT && job.fds[a] >= 0; a++) {
+        if (ok && !write_header(job.fds[a], &ARRAYS[a], job.rows)) {
+            perror(paths[a]);
+            ok = 0;
+        }
+        ok &= close(job.fds[a]) == 0;
+        bytes += NPY_HEADER + job.rows * ARRAYS[a].row;
+    }
+    if (!ok) {
+        fprintf(stderr, "termv: export to %s failed\n", opt->out_dir);
+        return 1;
+    }
+
+    double elapsed = util_now_seconds() - started;
+    printf("exported %llu placements from %d of %d replays to %s in %.3f s "
+           "(%d thread%s, %.1f MB)\n",
+           (unsigned long long)job.rows, job.exported, opt->replay_count, opt->out_dir,
+           elapsed, threads, threads == 1 ? "" : "s", bytes / (1024.0 * 1024.0));
+    return job.exported == opt->replay_count ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+/*
+ * Training-set export (`termv --export-dataset DIR REPLAY...`): replay
+ * recorded games and write one sample per locked piece as NumPy .npy
+ * arrays, loadable zero-copy with np.load(path, mmap_mode="r"):
+ *
+ *   boards.npy      uint8 (N, 20, 10)  visible rows before the piece, 1 = filled
+ *   pieces.npy      uint8 (N, 2)       current and next piece (I O T S Z J L = 0-6)
+ *   placements.npy  int8  (N, 3)       rotation, row, col where the piece locked,
+ *                                      in piece.h coordinates (visible rows 20-39)
+ *   rewards.npy     int32 (N, 2)       score gained and lines cleared by the piece
+ *   games.npy       uint32 (N,)        index of the replay on the command line
+ *
+ * Worker threads take replays in turn and buffer samples in fixed-size
+ * chunks. A full chunk reserves a range of rows and is written in place,
+ * so memory stays bounded however many games there are. Chunks land in
+ * the order they fill, not replay order; a game's samples stay in play
+ * order, and games.npy tells the games apart.
+ */
+
+typedef struct {
+    const char  *out_dir;
+    char *const *replays;
+    int          replay_count;
+    int          threads;      /* 0 = one per online CPU */
+} DatasetOptions;
+
+/* Run the export and print a summary. Returns a process exit status. */
+int dataset_run(const DatasetOptions *opt);
+
+#endif
@@ -0,0 +1,99 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "display.h"
+#include "theme.h"
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void *render_main(void *arg) {
+    Display *d = arg;
+    unsigned char drain[64];
+
+    for (;;) {
+        struct pollfd pfd = { d->wake[0], POLLIN, 0 };
+        if (poll(&pfd, 1, -1) < 0)
+            continue;
+        while (read(d->wake[0], drain, sizeof(drain)) > 0)
+            ;
+        if (!__atomic_load_n(&d->running, __ATOMIC_ACQUIRE))
+            break;
+
+        const Frame *f = tribuf_acquire(&d->frames);
+        if (!f)
+            continue;
+        for (; d->theme_cycles != f->theme_cycles; d->theme_cycles++)
+            theme_cycle();
+        uint64_t started = d->metrics ? now_ns() : 0;
+        render_set_scores(f->scores, f->score_count, f->score_rank);
+        render_set_hint(f->hint_enabled, &f->hint, f->hint_length);
+        if (f->versus)
+            render_draw_versus(&f->game, &f->opponent);
+        else
+            render_draw(&f->game);
+        d->drawn++;
+        if (d->metrics)
+            metrics_frame_drawn(d->metrics, now_ns() - started);
+    }
+    return NULL;
+}
+
+int display_init(Display *d) {
+    d->running = 0;
+    d->theme_cycles = 0;
+    d->drawn = 0;
+    d->metrics = NULL;
+    if (!tribuf_init(&d->frames, sizeof(Frame)))
+        return 0;
+    if (pipe(d->wake) != 0) {
+        tribuf_free(&d->frames);
+        return 0;
+    }
+    /* Neither end may block: a full pipe already means "wake up" */
+    fcntl(d->wake[0], F_SETFL, O_NONBLOCK);
+    fcntl(d->wake[1], F_SETFL, O_NONBLOCK);
+    return 1;
+}
+
+void display_free(Display *d) {
+    close(d->wake[0]);
+    close(d->wake[1]);
+    tribuf_free(&d->frames);
+}
+
+int display_start(Display *d) {
+    d->running = 1;
+    if (pthread_create(&d->thread, NULL, render_main, d) != 0) {
+        d->running = 0;
+        return 0;
+    }
+    return 1;
+}
+
+void display_stop(Display *d) {
+    if (!d->running)
+        return;
+    __atomic_store_n(&d->running, 0, __ATOMIC_RELEASE);
+    if (write(d->wake[1], "", 1) < 0) {
+        /* pipe full: the thread is already due to wake */
+    }
+    pthread_join(d->thread, NULL);
+}
+
+Frame *display_frame(Display *d) {
+    return tribuf_back(&d->frames);
+}
+
+void display_publish(Display *d) {
+    tribuf_publish(&d->frames);
+    if (write(d->wake[1], "", 1) < 0) {
+        /* pipe full: the thread is already due to wake */
+    }
+}
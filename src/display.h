@@ -0,0 +1,58 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "game.h"
+#include "render.h"
+#include "tribuf.h"
+#include "metrics.h"
+
+/*
+ * Render thread. The game loop fills a Frame and publishes it through a
+ * triple buffer; the render thread draws the newest one. A terminal that
+ * blocks in refresh() (a stalled SSH link, a slow emulator) then only
+ * delays drawing: gravity, lock delay and input keep running on time, and
+ * frames published meanwhile are skipped rather than queued.
+ *
+ * The render thread owns ncurses while it runs. Stop it before any other
+ * curses call, such as render_cleanup.
+ */
+
+/* Everything render_draw needs, copied out of the game thread's state */
+typedef struct {
+    Game       game;
+    int        versus;        /* draw opponent beside game */
+    Game       opponent;
+    int        hint_enabled;
+    Piece      hint;          /* current piece's perfect-clear placement */
+    int        hint_length;   /* pieces in the clear, 0 = none */
+    ScoreEntry scores[SCORES_SHOWN];
+    int        score_count;
+    int        score_rank;
+    unsigned   theme_cycles;  /* theme changes requested so far */
+} Frame;
+
+typedef struct {
+    TripleBuffer frames;
+    pthread_t    thread;
+    int          wake[2];       /* pipe: a byte per publish */
+    int          running;
+    unsigned     theme_cycles;  /* theme changes applied */
+    uint64_t     drawn;
+    Metrics     *metrics;       /* optional: draw times reported here */
+} Display;
+
+/* Allocate buffers. Returns 0 on failure. */
+int    display_init(Display *d);
+void   display_free(Display *d);
+
+/* Start and stop the render thread. */
+int    display_start(Display *d);
+void   display_stop(Display *d);
+
+/* Game thread: fill the returned frame, then publish it. */
+Frame *display_frame(Display *d);
+void   display_publish(Display *d);
+
+#endif
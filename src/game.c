@@ -6,31 +6,58 @@
 
 /* ── 7-bag randomizer ────────────────────────────────────────────── */
 
-static void bag_shuffle(Game *g) {
+static void bag_shuffle(PieceType bag[7], Rng *rng) {
     for (int i = 6; i > 0; i--) {
-        int j = rand() % (i + 1);
-        PieceType tmp = g->bag[i];
-        g->bag[i] = g->bag[j];
-        g->bag[j] = tmp;
+        int j = (int)rng_below(rng, (uint32_t)(i + 1));
+        PieceType tmp = bag[i];
+        bag[i] = bag[j];
+        bag[j] = tmp;
     }
-    g->bag_index = 0;
 }
 
-static void bag_fill(Game *g) {
-    for (int i = 0; i < 7; i++)
-        g->bag[i] = (PieceType)i;
-    bag_shuffle(g);
+PieceType bag_draw(PieceType bag[7], int *bag_index, Rng *rng) {
+    if (*bag_index >= 7) {
+        for (int i = 0; i < 7; i++)
+            bag[i] = (PieceType)i;
+        bag_shuffle(bag, rng);
+        *bag_index = 0;
+    }
+    return bag[(*bag_index)++];
 }
 
 static PieceType bag_next(Game *g) {
-    if (g->bag_index >= 7)
-        bag_fill(g);
-    return g->bag[g->bag_index++];
+    return bag_draw(g->bag, &g->bag_index, &g->rng);
+}
+
+void bag_sequence(unsigned int seed, uint64_t start, PieceType *out, size_t n) {
+    Rng rng;
+    PieceType bag[7];
+    int bag_index = 7;
+
+    /* Seek straight to the bag holding piece `start` */
+    rng_seed(&rng, seed);
+    rng_advance(&rng, (start / 7) * BAG_DRAWS);
+    for (uint64_t i = 0; i < start % 7; i++)
+        bag_draw(bag, &bag_index, &rng);
+
+    for (size_t i = 0; i < n; i++)
+        out[i] = bag_draw(bag, &bag_index, &rng);
+}
+
+void game_peek_queue(const Game *g, PieceType *out, size_t n) {
+    Rng rng = g->rng;
+    PieceType bag[7];
+    int bag_index = g->bag_index;
+
+    for (int i = 0; i < 7; i++)
+        bag[i] = g->bag[i];
+    for (size_t i = 0; i < n; i++)
+        out[i] = bag_draw(bag, &bag_index, &rng);
 }
 
 /* ── Gravity interval calculation ────────────────────────────────── */
 
-static double calc_gravity_interval(int level) {
+double game_level_gravity_interval(int level) {
     /* 500ms at level 0, decreasing by 20% each level, minimum 50ms */
     double interval = 500.0 * pow(0.8, level);
     if (interval < 50.0)
@@ -42,10 +69,16 @@ static double calc_gravity_interval(int level) {
 
 static const int LINE_SCORES[5] = {0, 100, 300, 500, 800};
 
+int game_line_clear_score(int lines_cleared, int level) {
+    if (lines_cleared < 1 || lines_cleared > 4)
+        return 0;
+    return LINE_SCORES[lines_cleared] * (level + 1);
+}
+
 static void apply_score_lines(Game *g, int lines_cleared) {
     if (lines_cleared < 1 || lines_cleared > 4)
         return;
-    g->score += LINE_SCORES[lines_cleared] * (g->level + 1);
+    g->score += game_line_clear_score(lines_cleared, g->level);
     g->lines += lines_cleared;
 
     /* Tetris! Trigger flash celebration */
@@ -59,7 +92,7 @@ static void apply_score_lines(Game *g, int lines_cleared) {
     int new_level = g->lines / 10;
     if (new_level > g->level) {
         g->level = new_level;
-        g->gravity_interval = calc_gravity_interval(g->level);
+        g->gravity_interval = game_level_gravity_interval(g->level);
     }
 }
 
@@ -71,19 +104,21 @@ void game_init(Game *g, unsigned int seed) {
     g->lines = 0;
     g->level = 0;
     g->soft_dropping = 0;
-    g->gravity_interval = calc_gravity_interval(0);
+    g->gravity_interval = game_level_gravity_interval(0);
     g->gravity_timer = 0.0;
     g->lock_delay = 500.0;  /* 500ms lock delay */
     g->lock_timer = 0.0;
     g->locking = 0;
     g->bag_index = 7;  /* Force refill on first call */
     g->seed = seed;
+    g->rotation = ROTATION_BASIC;
     g->flash_active = 0;
     g->flash_timer = 0.0;
     g->flash_count = 0;
 
-    srand(seed);
-    board_init();
+    rng_seed(&g->rng, seed);
+    board_init(&g->board);
+    stats_init(&g->stats);
 
     /* Pre-load next piece and spawn first piece */
     g->next = bag_next(g);
@@ -91,17 +126,24 @@ void game_init(Game *g, unsigned int seed) {
     g->state = STATE_RUNNING;
 }
 
+void game_set_rotation(Game *g, RotationSystem rs) {
+    g->rotation = rs;
+    piece_spawn(&g->current, g->current.type, rs);
+    if (g->state == STATE_RUNNING && !piece_valid(&g->board, &g->current))
+        g->state = STATE_GAMEOVER;
+}
+
 void game_new_piece(Game *g) {
     PieceType type = g->next;
     g->next = bag_next(g);
 
-    piece_spawn(&g->current, type);
+    piece_spawn(&g->current, type, g->rotation);
     g->locking = 0;
     g->lock_timer = 0.0;
     g->gravity_timer = 0.0;
 
     /* Check if spawn position is valid */
-    if (!piece_valid(&g->current)) {
+    if (!piece_valid(&g->board, &g->current)) {
         g->state = STATE_GAMEOVER;
     }
 }
@@ -109,9 +151,11 @@ void game_new_piece(Game *g) {
 void game_lock_piece(Game *g) {
     int cells[4][2];
     piece_get_cells(&g->current, cells);
-    board_lock(cells, piece_color(g->current.type));
+    board_lock(&g->board, cells, piece_color(g->current.type));
+    stats_piece_locked(&g->stats, &g->board, &g->current);
 
-    int cleared = board_clear_lines();
+    int cleared = board_clear_lines(&g->board);
+    stats_lines_cleared(&g->stats, cleared);
     if (cleared > 0) {
         apply_score_lines(g, cleared);
     }
@@ -141,7 +185,7 @@ void game_apply_gravity(Game *g, double dt_ms) {
         /* Try to move down */
         Piece next = g->current;
         next.row++;
-        if (piece_valid(&next)) {
+        if (piece_valid(&g->board, &next)) {
             g->current = next;
             /* Award soft drop point */
             if (g->soft_dropping)
@@ -169,15 +213,27 @@ void game_update_flash(Game *g, double dt_ms) {
     }
 }
 
+void game_update(Game *g, double dt_ms) {
+    if (g->state == STATE_RUNNING)
+        g->stats.time_ms += dt_ms;
+
+    /* Gravity is paused during the flash animation */
+    if (g->flash_active)
+        game_update_flash(g, dt_ms);
+    else if (g->state == STATE_RUNNING)
+        game_apply_gravity(g, dt_ms);
+}
+
 void game_hard_drop(Game *g) {
     if (g->state != STATE_RUNNING)
         return;
 
+    stats_hard_drop(&g->stats);
     int rows_dropped = 0;
     while (1) {
         Piece next = g->current;
         next.row++;
-        if (!piece_valid(&next))
+        if (!piece_valid(&g->board, &next))
             break;
         g->current = next;
         rows_dropped++;
@@ -189,11 +245,13 @@ void game_hard_drop(Game *g) {
 int game_move(Game *g, int drow, int dcol) {
     if (g->state != STATE_RUNNING)
         return 0;
+    if (dcol != 0)
+        stats_input(&g->stats);
 
     Piece next = g->current;
     next.row += drow;
     next.col += dcol;
-    if (piece_valid(&next)) {
+    if (piece_valid(&g->board, &next)) {
         g->current = next;
         /* If we moved while in lock delay, reset it */
         if (g->locking) {
@@ -201,7 +259,7 @@ int game_move(Game *g, int drow, int dcol) {
             /* Check if we're no longer on the ground */
             Piece below = g->current;
             below.row++;
-            if (piece_valid(&below)) {
+            if (piece_valid(&g->board, &below)) {
                 g->locking = 0;
             }
         }
@@ -213,14 +271,15 @@ int game_move(Game *g, int drow, int dcol) {
 int game_rotate(Game *g, int dir) {
     if (g->state != STATE_RUNNING)
         return 0;
+    stats_input(&g->stats);
 
-    if (piece_try_rotate(&g->current, dir)) {
+    if (piece_try_rotate(&g->board, &g->current, dir)) {
         /* Reset lock delay if rotating while locking */
         if (g->locking) {
             g->lock_timer = 0.0;
             Piece below = g->current;
             below.row++;
-            if (piece_valid(&below)) {
+            if (piece_valid(&g->board, &below)) {
                 g->locking = 0;
             }
         }
@@ -1,7 +1,11 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "piece.h"
+#include "rng.h"
+#include "stats.h"
 
 /* Game states */
 typedef enum {
@@ -15,8 +19,10 @@ typedef enum {
 /* Game context */
 typedef struct {
     GameState state;
+    Board     board;
     Piece     current;
     PieceType next;
+    RotationSystem rotation;
     int       score;
     int       lines;
     int       level;
@@ -33,19 +39,29 @@ typedef struct {
     double    lock_timer;
     int       locking;  /* 1 if piece is in lock delay */
 
-    /* RNG seed */
+    /* RNG seed and per-game generator state */
     unsigned int seed;
+    Rng          rng;
 
     /* Tetris flash animation */
     int    flash_active;   /* 1 if flash animation is running */
     double flash_timer;    /* time elapsed in current flash phase */
     int    flash_count;    /* number of inversion toggles remaining */
+
+    /* Play statistics (PPS, KPP, finesse, clears) */
+    GameStats stats;
 } Game;
 
 void game_init(Game *g, unsigned int seed);
+
+/* Switch rotation system; call right after game_init, before any moves. */
+void game_set_rotation(Game *g, RotationSystem rs);
 void game_new_piece(Game *g);
 void game_apply_gravity(Game *g, double dt_ms);
 void game_update_flash(Game *g, double dt_ms);
+
+/* Advance the game clock: runs the flash animation, or gravity when running. */
+void game_update(Game *g, double dt_ms);
 void game_lock_piece(Game *g);
 void game_hard_drop(Game *g);
 int  game_move(Game *g, int drow, int dcol);
@@ -56,4 +72,23 @@ void game_quit(Game *g);
 /* Get gravity interval based on current state (normal or soft drop). */
 double game_get_gravity_interval(const Game *g);
 
+/* Rules shared with the batch stepper (batch.c). */
+double game_level_gravity_interval(int level);
+int    game_line_clear_score(int lines_cleared, int level);
+
+/* Generator outputs consumed by each 7-bag shuffle. */
+#define BAG_DRAWS 6
+
+/* Draw from a 7-bag, refilling and shuffling it from rng when empty. */
+PieceType bag_draw(PieceType bag[7], int *bag_index, Rng *rng);
+
+/*
+ * Pieces start .. start+n-1 of the sequence dealt for seed (piece 0 is the
+ * first current piece). Seeks in O(log start) rather than replaying.
+ */
+void bag_sequence(unsigned int seed, uint64_t start, PieceType *out, size_t n);
+
+/* The n pieces that will follow g->next, without disturbing g. */
+void game_peek_queue(const Game *g, PieceType *out, size_t n);
+
 #endif
@@ -0,0 +1,77 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "hint.h"
+#include <string.h>
+
+static void *hint_main(void *arg) {
+    HintSearch *h = arg;
+    Game game;
+    Piece path[PC_MAX_PIECES];
+
+    pthread_mutex_lock(&h->lock);
+    for (;;) {
+        while (h->running && h->answered == h->requested)
+            pthread_cond_wait(&h->wake, &h->lock);
+        if (!h->running)
+            break;
+
+        uint32_t id = h->requested;
+        game = h->game;
+        pthread_mutex_unlock(&h->lock);
+        int length = pc_find_game(&game, 0, path);
+        pthread_mutex_lock(&h->lock);
+
+        /* A newer request came in meanwhile: this answer is stale */
+        if (h->requested == id) {
+            memcpy(h->path, path, (size_t)length * sizeof(*path));
+            h->length = length;
+            h->answered = id;
+        }
+    }
+    pthread_mutex_unlock(&h->lock);
+    return NULL;
+}
+
+int hint_start(HintSearch *h) {
+    h->requested = h->answered = 0;
+    h->length = 0;
+    h->running = 1;
+    pthread_mutex_init(&h->lock, NULL);
+    pthread_cond_init(&h->wake, NULL);
+    if (pthread_create(&h->thread, NULL, hint_main, h) != 0) {
+        pthread_cond_destroy(&h->wake);
+        pthread_mutex_destroy(&h->lock);
+        h->running = 0;
+        return 0;
+    }
+    return 1;
+}
+
+void hint_stop(HintSearch *h) {
+    pthread_mutex_lock(&h->lock);
+    h->running = 0;
+    pthread_cond_signal(&h->wake);
+    pthread_mutex_unlock(&h->lock);
+    pthread_join(h->thread, NULL);
+    pthread_cond_destroy(&h->wake);
+    pthread_mutex_destroy(&h->lock);
+}
+
+void hint_request(HintSearch *h, const Game *g, uint32_t id) {
+    pthread_mutex_lock(&h->lock);
+    h->game = *g;
+    h->requested = id;
+    pthread_cond_signal(&h->wake);
+    pthread_mutex_unlock(&h->lock);
+}
+
+int hint_result(HintSearch *h, uint32_t id, Piece *path, int *length) {
+    pthread_mutex_lock(&h->lock);
+    int ready = h->answered == id;
+    if (ready) {
+        memcpy(path, h->path, (size_t)h->length * sizeof(*path));
+        *length = h->length;
+    }
+    pthread_mutex_unlock(&h->lock);
+    return ready;
+}
@@ -0,0 +1,41 @@
+#ifndef HINT_H
+#define HINT_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "game.h"
+#include "pc.h"
+
+/*
+ * Perfect-clear hint searched off the game thread. The game loop posts a
+ * copy of the game whenever a new piece spawns and keeps running; the
+ * hint thread searches the newest request and leaves its answer to be
+ * picked up on a later frame. A request not yet started is replaced by a
+ * newer one, so a hint is never searched for a piece already gone.
+ */
+
+typedef struct {
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+    int             running;
+
+    /* Under lock */
+    Game            game;              /* position to search */
+    uint32_t        requested;         /* id of the newest request */
+    uint32_t        answered;          /* id the result belongs to */
+    Piece           path[PC_MAX_PIECES];
+    int             length;
+} HintSearch;
+
+/* Start and stop the hint thread. */
+int  hint_start(HintSearch *h);
+void hint_stop(HintSearch *h);
+
+/* Ask for a search of g, tagged id (nonzero, new for every request). */
+void hint_request(HintSearch *h, const Game *g, uint32_t id);
+
+/* Copy out the answer to request id. Returns 0 if it is not in yet. */
+int  hint_result(HintSearch *h, uint32_t id, Piece *path, int *length);
+
+#endif
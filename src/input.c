@@ -1,24 +1,65 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "input.h"
-#include "theme.h"
-#include <ncurses.h>
+#include "util.h"
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
 
-InputAction input_poll(void) {
-    int ch = getch();
-    if (ch == ERR)
-        return ACTION_NONE;
+#define ESC_DELAY_MS     50.0  /* a lone ESC is the Escape key after this long */
+#define INPUT_INCOMPLETE (-1)  /* escape sequence cut short by the end of the buffer */
 
-    switch (ch) {
-        case KEY_LEFT:
-            return ACTION_LEFT;
-        case KEY_RIGHT:
-            return ACTION_RIGHT;
-        case KEY_DOWN:
+/* Bytes read from the terminal but not yet turned into actions */
+static unsigned char pending[64];
+static int pending_len = 0;
+static int pending_pos = 0;
+static int escape_waiting = 0;  /* an unfinished sequence is waiting for bytes */
+static double escape_since;
+
+/*
+ * Decode the rest of an escape sequence (after ESC). Unless final, a
+ * sequence that runs off the end of the buffer may still be arriving and
+ * is INPUT_INCOMPLETE.
+ */
+static int input_escape(int final) {
+    if (pending_pos == pending_len)
+        return final ? ACTION_QUIT : INPUT_INCOMPLETE;  /* a lone Escape key */
+
+    unsigned char intro = pending[pending_pos];
+    if (intro != '[' && intro != 'O')
+        return ACTION_QUIT;
+    pending_pos++;
+
+    /* CSI parameters, e.g. "1;2" for Shift */
+    int shifted = 0;
+    while (pending_pos < pending_len
+           && pending[pending_pos] >= 0x30 && pending[pending_pos] <= 0x3F) {
+        if (pending[pending_pos] == '2' && pending[pending_pos - 1] == ';')
+            shifted = 1;
+        pending_pos++;
+    }
+    if (pending_pos == pending_len)
+        return final ? ACTION_NONE : INPUT_INCOMPLETE;
+
+    switch (pending[pending_pos++]) {
+        case 'A':
+            return shifted ? ACTION_ROTATE_CW : ACTION_ROTATE_CCW;
+        case 'B':
             return ACTION_DOWN;
-        case KEY_UP:
+        case 'C':
+            return ACTION_RIGHT;
+        case 'D':
+            return ACTION_LEFT;
+        default:
+            return ACTION_NONE;
+    }
+}
+
+static int key_action(int ch) {
+    switch (ch) {
         case 'z':
         case 'Z':
             return ACTION_ROTATE_CCW;
-        case KEY_SR:       /* Shift+Up in some terminals */
         case 'x':
         case 'X':
             return ACTION_ROTATE_CW;
@@ -30,15 +71,73 @@ InputAction input_poll(void) {
         case 't':
         case 'T':
             return ACTION_THEME;
+        case 'h':
+        case 'H':
+            return ACTION_HINT;
         case 'q':
         case 'Q':
-        case 27:  /* Escape */
             return ACTION_QUIT;
         default:
             return ACTION_NONE;
     }
 }
 
+/* Decode one key at pending_pos; an incomplete sequence is left unread. */
+static int decode(int final) {
+    int start = pending_pos;
+    int ch = pending[pending_pos++];
+    int action = ch == 27 ? input_escape(final) : key_action(ch);
+    if (action == INPUT_INCOMPLETE)
+        pending_pos = start;
+    return action;
+}
+
+/* Append whatever the terminal has ready. Returns 0 if nothing came. */
+static int read_more(void) {
+    struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+    size_t room = sizeof(pending) - (size_t)pending_len;
+    if (room == 0 || poll(&pfd, 1, 0) <= 0)
+        return 0;
+    ssize_t n = read(STDIN_FILENO, pending + pending_len, room);
+    if (n <= 0)
+        return 0;
+    pending_len += (int)n;
+    return 1;
+}
+
+InputAction input_poll(void) {
+    for (;;) {
+        if (pending_pos < pending_len) {
+            int action = decode(pending_len == (int)sizeof(pending));
+            if (action != INPUT_INCOMPLETE) {
+                escape_waiting = 0;
+                return (InputAction)action;
+            }
+        }
+
+        /* Keep an unfinished sequence at the front and read after it */
+        memmove(pending, pending + pending_pos, (size_t)(pending_len - pending_pos));
+        pending_len -= pending_pos;
+        pending_pos = 0;
+        if (!read_more())
+            break;
+    }
+    if (pending_len == 0)
+        return ACTION_NONE;
+
+    /* A sequence split across reads usually completes within a frame or
+     * two; one that doesn't is taken as it stands, like ncurses' ESCDELAY */
+    double now = util_now_ms();
+    if (!escape_waiting) {
+        escape_waiting = 1;
+        escape_since = now;
+    }
+    if (now - escape_since < ESC_DELAY_MS)
+        return ACTION_NONE;
+    escape_waiting = 0;
+    return (InputAction)decode(1);
+}
+
 void input_handle(Game *g, InputAction action) {
     switch (action) {
         case ACTION_LEFT:
@@ -66,12 +165,11 @@ void input_handle(Game *g, InputAction action) {
         case ACTION_PAUSE:
             game_toggle_pause(g);
             break;
-        case ACTION_THEME:
-            theme_cycle();
-            break;
         case ACTION_QUIT:
             game_quit(g);
             break;
+        case ACTION_THEME:
+        case ACTION_HINT:
         case ACTION_NONE:
             break;
     }
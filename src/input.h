@@ -14,11 +14,23 @@ typedef enum {
     ACTION_ROTATE_CCW,
     ACTION_HARD_DROP,
     ACTION_PAUSE,
-    ACTION_THEME,
+    ACTION_THEME,      /* handled by the caller, not game actions */
+    ACTION_HINT,
     ACTION_QUIT
 } InputAction;
 
-/* Read a key from ncurses (non-blocking). Returns ACTION_*. */
+/*
+ * Soft-drop key tracking:
+ * Since terminals don't send key-release events, we use a simple heuristic:
+ * if we haven't seen Down for this long, consider it released.
+ */
+#define SOFT_DROP_TIMEOUT_MS 150.0
+
+/*
+ * Read a key straight from the terminal (non-blocking), decoding arrow-key
+ * escape sequences. Returns ACTION_*. This bypasses ncurses so the game
+ * thread never touches curses state owned by the render thread.
+ */
 InputAction input_poll(void);
 
 /* Process an action on the game. */
@@ -0,0 +1,52 @@
+#include "layout.h"
+#include "board.h"
+#include "piece.h"
+#include <string.h>
+
+/* Mark the visible cells of p that are still empty, or all of them with over set */
+static void put_piece(const Piece *p, LayoutKind kind, int over,
+                      LayoutCell out[VISIBLE_HEIGHT][BOARD_WIDTH]) {
+    int cells[4][2];
+    piece_get_cells(p, cells);
+    for (int i = 0; i < 4; i++) {
+        int vr = cells[i][0] - HIDDEN_HEIGHT;
+        int vc = cells[i][1];
+        if (vr < 0 || vr >= VISIBLE_HEIGHT || vc < 0 || vc >= BOARD_WIDTH)
+            continue;
+        if (over || out[vr][vc].kind != LAYOUT_BLOCK) {
+            out[vr][vc].kind = (unsigned char)kind;
+            out[vr][vc].color = (unsigned char)piece_color(p->type);
+        }
+    }
+}
+
+void layout_playfield(const Game *g, const Piece *hint,
+                      LayoutCell out[VISIBLE_HEIGHT][BOARD_WIDTH]) {
+    memset(out, 0, sizeof(LayoutCell) * VISIBLE_HEIGHT * BOARD_WIDTH);
+
+    for (int r = 0; r < VISIBLE_HEIGHT; r++) {
+        const int *row = board_row(&g->board, HIDDEN_HEIGHT + r);
+        for (int c = 0; c < BOARD_WIDTH; c++) {
+            if (row[c] > 0) {
+                out[r][c].kind = LAYOUT_BLOCK;
+                out[r][c].color = (unsigned char)row[c];
+            }
+        }
+    }
+
+    if (g->state == STATE_RUNNING) {
+        Piece ghost = g->current;
+        ghost.row = piece_ghost_row(&g->board, &g->current);
+        put_piece(&ghost, LAYOUT_GHOST, 0, out);
+        if (hint)
+            put_piece(hint, LAYOUT_HINT, 0, out);
+        put_piece(&g->current, LAYOUT_BLOCK, 1, out);
+    }
+
+    /* Every other flash phase shows the filled cells inverted */
+    if (g->flash_active && g->flash_count % 2 == 1)
+        for (int r = 0; r < VISIBLE_HEIGHT; r++)
+            for (int c = 0; c < BOARD_WIDTH; c++)
+                if (out[r][c].kind == LAYOUT_BLOCK)
+                    out[r][c].kind = LAYOUT_FLASH;
+}
@@ -0,0 +1,44 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "game.h"
+
+/*
+ * One player's screen layout, shared by the terminal frontend and the
+ * offline replay renderer (3-column):
+ *   Left panel:  score, lines, level, theme
+ *   Center:      playfield (10 cells wide × 20 rows, each cell = 2 chars)
+ *   Right panel: next piece, status, controls
+ */
+
+/* Offsets from the layout's top-left corner (row, col) */
+#define LAYOUT_FIELD_Y  1
+#define LAYOUT_LEFT_X   2
+#define LAYOUT_LEFT_W   14
+#define LAYOUT_FIELD_X  (LAYOUT_LEFT_X + LAYOUT_LEFT_W)        /* board starts after left panel */
+#define LAYOUT_PANEL_X  (LAYOUT_FIELD_X + BOARD_WIDTH * 2 + 3)  /* right of playfield + border */
+#define LAYOUT_WIDTH    56
+#define LAYOUT_HEIGHT   (LAYOUT_FIELD_Y + VISIBLE_HEIGHT + 1)
+
+/* What a visible playfield cell shows */
+typedef enum {
+    LAYOUT_EMPTY,
+    LAYOUT_BLOCK,  /* locked cell or active piece */
+    LAYOUT_FLASH,  /* filled cell in the inverted phase of the line-clear flash */
+    LAYOUT_GHOST,  /* where the active piece would land */
+    LAYOUT_HINT    /* perfect-clear placement of the active piece */
+} LayoutKind;
+
+typedef struct {
+    unsigned char kind;   /* LayoutKind */
+    unsigned char color;  /* color id of the block or hint */
+} LayoutCell;
+
+/*
+ * Fill out with the visible playfield: locked cells, then the ghost, the
+ * hint (NULL for none) and the active piece on top.
+ */
+void layout_playfield(const Game *g, const Piece *hint,
+                      LayoutCell out[VISIBLE_HEIGHT][BOARD_WIDTH]);
+
+#endif
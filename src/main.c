@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include <ncurses.h>
 
 #include "board.h"
@@ -11,21 +12,59 @@
 #include "game.h"
 #include "render.h"
 #include "input.h"
+#include "snapshot.h"
+#include "agent.h"
+#include "scores.h"
+#include "pacer.h"
+#include "perft.h"
+#include "seedfind.h"
+#include "dataset.h"
+#include "pc.h"
+#include "hint.h"
+#include "display.h"
+#include "replay.h"
+#include "cast.h"
+#include "corpus.h"
+#include "netplay.h"
+#include "metrics.h"
+#include "watch.h"
+#include "bot.h"
 #include "version.h"
+#include "util.h"
 
-/* Get current time in milliseconds (monotonic clock) */
-static double time_ms(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+static void usage(void) {
+    fprintf(stderr,
+            "usage: termv [--hibernate-after SECONDS] [--hibernate-file PATH] [--no-scores]\n"
+            "             [--rotation basic|srs|ars] [--stats PATH] [--fps HZ] [--fixed-step]\n"
+            "             [--record PATH] [--metrics SOCKET] [seed]\n"
+            "       termv --render-replay IN OUT [--format cast|ansi] [--fps HZ]\n"
+            "       termv [--fps HZ] [--budget KBS] --watch REPLAY|AGENT-SEGMENT...\n"
+            "       termv --corpus-add DB REPLAY... [--threads N]\n"
+            "       termv --corpus-query DB FILTER [--limit N] [--threads N]\n"
+            "       termv --corpus-levels DB [--threads N]\n"
+            "       termv [--threads N] --export-dataset DIR REPLAY...\n"
+            "       termv --versus PORT HOST:PORT [--input-delay TICKS] [--net-delay MS]\n"
+            "             [--net-loss PCT] [--rotation NAME] [seed]\n"
+            "       termv --agent PATH [--games N] [seed]\n"
+            "       termv --bot-protocol COMMAND [--games N] [--rotation NAME] [seed]\n"
+            "       termv --perft SEED DEPTH [--rotation NAME] [--threads N] [--tt-mb MB]\n"
+            "       termv --find-seed QUERY [--limit N] [--threads N]\n");
 }
 
-/*
- * Soft-drop key tracking:
- * Since ncurses doesn't give key-release events, we use a simple heuristic:
- * if we haven't seen KEY_DOWN for a few frames, consider it released.
- */
-#define SOFT_DROP_TIMEOUT_MS 150.0
+/* Apply an action to the game, and to the recording if there is one. */
+static void play_action(Game *g, InputAction action, ReplayWriter *rec) {
+    input_handle(g, action);
+    if (rec)
+        replay_action(rec, action);
+}
+
+/* Append a JSON-lines record for each piece locked since the last call. */
+static void stream_stats(FILE *f, const Game *g, uint32_t *seen) {
+    if (!f || g->stats.pieces == *seen)
+        return;
+    *seen = g->stats.pieces;
+    stats_write_json(f, &g->stats, "piece");
+}
 
 int main(int argc, char *argv[]) {
     if (argc > 1 && (strcmp(argv[1], "--version") == 0 || strcmp(argv[1], "-v") == 0)) {
@@ -33,34 +72,336 @@ int main(int argc, char *argv[]) {
         return 0;
     }
 
-    unsigned int seed;
-    if (argc > 1) {
-        seed = (unsigned int)atoi(argv[1]);
-    } else {
-        seed = (unsigned int)time(NULL);
+    unsigned int seed = (unsigned int)time(NULL);
+    int game_chosen = 0;  /* seed or rotation given: start that game, don't resume */
+    double hibernate_after_ms = 0.0;  /* 0 = never hibernate */
+    char hibernate_path[512] = "";
+    const char *agent_path = NULL;
+    const char *bot_command = NULL;
+    unsigned int agent_games = 1;
+    int use_scores = 1;
+    const char *stats_path = NULL;
+    int fps = PACER_DEFAULT_HZ;
+    RotationSystem rotation = ROTATION_BASIC;
+    int fixed_step = 0;  /* 1 = advance the game by whole frame periods */
+    PerftOptions perft = { 0, 0, 0, 256, ROTATION_BASIC };
+    int run_perft = 0;
+    const char *seed_query = NULL;
+    const char *record_path = NULL;
+    const char *metrics_path = NULL;
+    CastOptions cast = { NULL, NULL, CAST_ASCIICAST, PACER_DEFAULT_HZ };
+    CorpusOptions corpus = { CORPUS_QUERY, NULL, NULL, 0, NULL, 20, 0 };
+    NetplayOptions versus = { 0, ROTATION_BASIC, 0, NULL, 2, 0, 0 };
+    DatasetOptions dataset = { NULL, NULL, 0, 0 };
+    WatchOptions watch = { NULL, 0, PACER_DEFAULT_HZ, WATCH_DEFAULT_BUDGET_KBS };
+    int run_watch = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--hibernate-after") == 0 && i + 1 < argc) {
+            hibernate_after_ms = atof(argv[++i]) * 1000.0;
+        } else if (strcmp(argv[i], "--hibernate-file") == 0 && i + 1 < argc) {
+            snprintf(hibernate_path, sizeof(hibernate_path), "%s", argv[++i]);
+        } else if (strcmp(argv[i], "--agent") == 0 && i + 1 < argc) {
+            agent_path = argv[++i];
+        } else if (strcmp(argv[i], "--bot-protocol") == 0 && i + 1 < argc) {
+            bot_command = argv[++i];
+        } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            agent_games = (unsigned int)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-scores") == 0) {
+            use_scores = 0;
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = atoi(argv[++i]);
+            if (fps < PACER_MIN_HZ || fps > PACER_MAX_HZ) {
+                fprintf(stderr, "termv: --fps must be %d-%d\n", PACER_MIN_HZ, PACER_MAX_HZ);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--rotation") == 0 && i + 1 < argc) {
+            if (!rotation_system_parse(argv[++i], &rotation)) {
+                fprintf(stderr, "termv: unknown rotation system '%s'\n", argv[i]);
+                return 1;
+            }
+            game_chosen = 1;
+        } else if (strcmp(argv[i], "--perft") == 0 && i + 2 < argc) {
+            run_perft = 1;
+            perft.seed = (unsigned int)atoi(argv[++i]);
+            perft.depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--find-seed") == 0 && i + 1 < argc) {
+            seed_query = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            perft.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tt-mb") == 0 && i + 1 < argc) {
+            perft.table_mb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fixed-step") == 0) {
+            fixed_step = 1;
+        } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            stats_path = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metrics_path = argv[++i];
+        } else if (strcmp(argv[i], "--render-replay") == 0 && i + 2 < argc) {
+            cast.replay_path = argv[++i];
+            cast.out_path = argv[++i];
+        } else if (strcmp(argv[i], "--corpus-add") == 0 && i + 1 < argc) {
+            /* Every remaining argument is a replay, so a shell glob works */
+            corpus.mode = CORPUS_ADD;
+            corpus.db_path = argv[++i];
+            corpus.replays = argv + i + 1;
+            corpus.replay_count = argc - i - 1;
+            break;
+        } else if (strcmp(argv[i], "--export-dataset") == 0 && i + 1 < argc) {
+            /* Every remaining argument is a replay, as with --corpus-add */
+            dataset.out_dir = argv[++i];
+            dataset.replays = argv + i + 1;
+            dataset.replay_count = argc - i - 1;
+            break;
+        } else if (strcmp(argv[i], "--watch") == 0) {
+            /* Every remaining argument is a source, as with --corpus-add */
+            run_watch = 1;
+            watch.sources = argv + i + 1;
+            watch.source_count = argc - i - 1;
+            break;
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            watch.budget_kbs = atoi(argv[++i]);
+            if (watch.budget_kbs <= 0) {
+                fprintf(stderr, "termv: --budget must be positive\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--corpus-query") == 0 && i + 2 < argc) {
+            corpus.mode = CORPUS_QUERY;
+            corpus.db_path = argv[++i];
+            corpus.filter = argv[++i];
+        } else if (strcmp(argv[i], "--corpus-levels") == 0 && i + 1 < argc) {
+            corpus.mode = CORPUS_LEVELS;
+            corpus.db_path = argv[++i];
+        } else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+            corpus.limit = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--versus") == 0 && i + 2 < argc) {
+            versus.local_port = atoi(argv[++i]);
+            versus.remote = argv[++i];
+        } else if (strcmp(argv[i], "--input-delay") == 0 && i + 1 < argc) {
+            versus.input_delay = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--net-delay") == 0 && i + 1 < argc) {
+            versus.delay_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc) {
+            versus.loss_pct = atoi(argv[++i]);
+            if (versus.loss_pct < 0 || versus.loss_pct > 100) {
+                fprintf(stderr, "termv: --net-loss must be 0-100\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            if (!cast_format_parse(argv[++i], &cast.format)) {
+                fprintf(stderr, "termv: unknown replay format '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (argv[i][0] != '-') {
+            seed = (unsigned int)atoi(argv[i]);
+            game_chosen = 1;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    /* Placement-tree counter */
+    if (run_perft) {
+        perft.rotation = rotation;
+        return perft_run(&perft);
+    }
+
+    /* Seed search */
+    if (seed_query) {
+        SeedFindOptions find = { seed_query, corpus.limit, perft.threads };
+        return seedfind_run(&find);
+    }
+
+    /* Replay corpus */
+    if (corpus.db_path) {
+        corpus.threads = perft.threads;
+        return corpus_run(&corpus);
+    }
+
+    /* Training-set export */
+    if (dataset.out_dir) {
+        dataset.threads = perft.threads;
+        return dataset_run(&dataset);
+    }
+
+    /* Tiled viewer */
+    if (run_watch) {
+        watch.fps = fps;
+        return watch_run(&watch);
+    }
+
+    /* Offline replay rendering */
+    if (cast.replay_path) {
+        cast.fps = fps;
+        return cast_run(&cast);
+    }
+
+    /* Two-player rollback match; both sides must pass the same seed */
+    if (versus.remote) {
+        versus.seed = seed;
+        versus.rotation = rotation;
+        return netplay_run(&versus);
+    }
+
+    /* Headless bot over pipes */
+    if (bot_command) {
+        BotOptions bot = { bot_command, agent_games, seed, rotation };
+        return bot_run(&bot);
+    }
+
+    /* Headless external-agent mode */
+    if (agent_path)
+        return agent_run(agent_path, agent_games, seed);
+
+    /* Hibernated sessions live in a directory only this user can write */
+    if (hibernate_path[0] == '\0') {
+        const char *runtime = getenv("XDG_RUNTIME_DIR");
+        char dir[512];
+        if (runtime && *runtime)
+            snprintf(hibernate_path, sizeof(hibernate_path), "%s/termv.snap", runtime);
+        else if (scores_default_dir(dir, sizeof(dir))
+                 && (hibernate_after_ms <= 0.0 || scores_make_dir(dir))
+                 && snprintf(hibernate_path, sizeof(hibernate_path), "%s/session.snap", dir)
+                    >= (int)sizeof(hibernate_path))
+            hibernate_path[0] = '\0';
+    }
+
+    /* Pick up a session hibernated by an earlier run, unless the command
+     * line asks for a particular game */
+    Game game;
+    int resumed = !game_chosen && hibernate_path[0] != '\0'
+               && snapshot_load(&game, hibernate_path);
+    if (resumed) {
+        unlink(hibernate_path);
+        fprintf(stderr, "termv: resuming the session hibernated to %s (seed %u)\n",
+                hibernate_path, game.seed);
+        if (record_path) {
+            fprintf(stderr, "termv: not recording a resumed session\n");
+            record_path = NULL;
+        }
+    }
+
+    /* Local leaderboard (optional: play on if it can't be opened) */
+    ScoreStore *scores = NULL;
+    char scores_dir[512];
+    if (use_scores && scores_default_dir(scores_dir, sizeof(scores_dir)))
+        scores = scores_open(scores_dir);
+    int score_recorded = 0;
+    int score_rank = 0;
+
+    /* Live statistics stream, one JSON object per line */
+    FILE *stats_out = NULL;
+    uint32_t stats_seen = 0;
+    if (stats_path) {
+        stats_out = fopen(stats_path, "w");
+        if (!stats_out) {
+            perror(stats_path);
+            scores_close(scores);
+            return 1;
+        }
+        setvbuf(stats_out, NULL, _IOLBF, 0);
     }
 
-    /* Initialize ncurses */
+    /* Input recording, replayed with --render-replay */
+    ReplayWriter recording;
+    ReplayWriter *rec = NULL;
+    double step_carry = 0.0;  /* sub-millisecond time not yet recorded */
+    if (record_path) {
+        if (!replay_create(&recording, record_path, seed, rotation)) {
+            perror(record_path);
+            if (stats_out)
+                fclose(stats_out);
+            scores_close(scores);
+            return 1;
+        }
+        rec = &recording;
+    }
+
+    /* Live counters for a local scraper, served from their own thread */
+    Metrics metrics_store;
+    Metrics *metrics = NULL;
+    MetricsServer metrics_server;
+    if (metrics_path) {
+        metrics_init(&metrics_store);
+        if (!metrics_serve_start(&metrics_server, metrics_path, &metrics_store)) {
+            perror(metrics_path);
+            if (rec)
+                replay_close(rec);
+            if (stats_out)
+                fclose(stats_out);
+            scores_close(scores);
+            return 1;
+        }
+        metrics = &metrics_store;
+    }
+
+    /* Initialize ncurses, drawn from its own thread */
+    Display display;
+    if (!display_init(&display)) {
+        fprintf(stderr, "termv: cannot set up the display\n");
+        if (metrics)
+            metrics_serve_stop(&metrics_server);
+        if (rec)
+            replay_close(rec);
+        if (stats_out)
+            fclose(stats_out);
+        scores_close(scores);
+        return 1;
+    }
+    display.metrics = metrics;
     render_init();
+    display_start(&display);
 
     /* Initialize game */
-    Game game;
-    game_init(&game, seed);
+    if (!resumed) {
+        game_init(&game, seed);
+        game_set_rotation(&game, rotation);
+    }
+
+    FramePacer pacer;
+    pacer_init(&pacer, fps);
+    int periods = 0;  /* frame periods since the previous frame */
+
+    /* Perfect-clear hint, searched on its own thread for each new piece while shown */
+    HintSearch hints;
+    int hints_running = hint_start(&hints);
+    int hint_enabled = 0;
+    uint32_t hint_piece = UINT32_MAX;
+    uint32_t hint_id = 0;  /* newest request */
+    Piece hint_path[PC_MAX_PIECES];
+    int hint_length = 0;
+
+    ScoreEntry score_top[SCORES_SHOWN];
+    int score_count = 0;
+    unsigned theme_cycles = 0;
 
-    double last_time = time_ms();
+    double last_time = util_now_ms();
+    double last_input = last_time;
     double soft_drop_last_seen = 0.0;
     int soft_drop_active = 0;
+    int hibernated = 0;
 
     /* Main game loop */
     while (game.state != STATE_QUIT) {
-        double now = time_ms();
+        double now = util_now_ms();
         double dt = now - last_time;
         last_time = now;
 
+        /* In fixed-step mode gravity advances in whole frames, so every
+         * gravity step lands on a frame boundary */
+        if (fixed_step)
+            dt = periods * pacer_period_ms(&pacer);
+
         /* Poll all available input this frame */
         InputAction action;
         int got_down = 0;
+        unsigned inputs = 0;
         while ((action = input_poll()) != ACTION_NONE) {
+            last_input = now;
+            inputs++;
             if (action == ACTION_DOWN) {
                 got_down = 1;
                 soft_drop_last_seen = now;
@@ -69,42 +410,115 @@ int main(int argc, char *argv[]) {
                     game.soft_dropping = 1;
                 }
             }
-            input_handle(&game, action);
+            if (action == ACTION_HINT && hints_running) {
+                hint_enabled = !hint_enabled;
+                hint_piece = UINT32_MAX;
+                hint_length = 0;
+            }
+            if (action == ACTION_THEME)
+                theme_cycles++;
+            play_action(&game, action, rec);
+            stream_stats(stats_out, &game, &stats_seen);
         }
 
         /* Soft drop release heuristic */
         if (soft_drop_active && !got_down) {
             if (now - soft_drop_last_seen > SOFT_DROP_TIMEOUT_MS) {
                 soft_drop_active = 0;
-                game.soft_dropping = 0;
+                play_action(&game, ACTION_DOWN_RELEASE, rec);
             }
         }
 
+        /* Recordings advance in whole milliseconds */
+        if (rec) {
+            step_carry += dt;
+            dt = (double)(unsigned)step_carry;
+            step_carry -= dt;
+            replay_step(rec, (unsigned)dt);
+        }
+
         /* Apply gravity (paused during flash animation) */
-        if (game.flash_active) {
-            game_update_flash(&game, dt);
-        } else if (game.state == STATE_RUNNING) {
-            game_apply_gravity(&game, dt);
+        game_update(&game, dt);
+        stream_stats(stats_out, &game, &stats_seen);
+
+        /* Record the final score once, and show the leaderboard */
+        if (game.state == STATE_GAMEOVER && !score_recorded) {
+            score_recorded = 1;
+            if (scores) {
+                ScoreEntry e = { (uint32_t)game.score, (uint32_t)game.lines,
+                                 (uint32_t)game.level, (uint32_t)time(NULL) };
+                score_rank = scores_record(scores, SCORES_MODE_MARATHON, game.seed, &e);
+                score_count = scores_top(scores, SCORES_MODE_MARATHON, 0, 1,
+                                         score_top, SCORES_SHOWN);
+            }
         }
 
-        /* Render */
-        render_draw(&game);
-
-        /* Cap at ~60 FPS (16.6ms per frame) */
-        double frame_time = time_ms() - now;
-        double sleep_ms = 16.0 - frame_time;
-        if (sleep_ms > 0) {
-            struct timespec req;
-            req.tv_sec = 0;
-            req.tv_nsec = (long)(sleep_ms * 1000000);
-            nanosleep(&req, NULL);
+        /* The previous piece's hint is dropped; the new one shows once found */
+        if (hint_enabled && game.state == STATE_RUNNING && game.stats.pieces != hint_piece) {
+            hint_piece = game.stats.pieces;
+            hint_length = 0;
+            hint_request(&hints, &game, ++hint_id);
         }
+        if (hint_enabled)
+            hint_result(&hints, hint_id, hint_path, &hint_length);
+
+        /* Hand the frame to the render thread; never wait for the terminal */
+        Frame *frame = display_frame(&display);
+        frame->game = game;
+        frame->versus = 0;
+        frame->hint_enabled = hint_enabled;
+        if (hint_length > 0)
+            frame->hint = hint_path[0];
+        frame->hint_length = hint_length;
+        memcpy(frame->scores, score_top, (size_t)score_count * sizeof(*score_top));
+        frame->score_count = score_count;
+        frame->score_rank = score_rank;
+        frame->theme_cycles = theme_cycles;
+        display_publish(&display);
+        if (metrics)
+            metrics_game_frame(metrics, &game, inputs, pacer.skipped);
+
+        /* Hibernate sessions left paused: save and exit, and the next run
+         * picks the game up again. A finished game has nothing to resume,
+         * and its score is already recorded */
+        if (hibernate_after_ms > 0.0 && hibernate_path[0] != '\0' && game.state == STATE_PAUSED
+            && now - last_input >= hibernate_after_ms
+            && snapshot_save(&game, hibernate_path)) {
+            hibernated = 1;
+            break;
+        }
+
+        /* Sleep to the next frame deadline */
+        periods = pacer_wait(&pacer);
     }
 
     /* Cleanup */
+    if (hints_running)
+        hint_stop(&hints);
+    display_stop(&display);
     render_cleanup();
-    printf("Game Over! Score: %d | Lines: %d | Level: %d\n",
-           game.score, game.lines, game.level);
+    display_free(&display);
+    if (metrics)
+        metrics_serve_stop(&metrics_server);
+    scores_close(scores);
+    if (rec && !replay_close(rec))
+        fprintf(stderr, "termv: failed to write recording %s\n", record_path);
+    if (stats_out) {
+        stats_write_json(stats_out, &game.stats, "end");
+        fclose(stats_out);
+    }
+    if (hibernated)
+        printf("termv: session hibernated to %s, run termv again to resume\n",
+               hibernate_path);
+    else
+        printf("Game Over! Score: %d | Lines: %d | Level: %d\n",
+               game.score, game.lines, game.level);
+    if (score_rank > 0)
+        printf("High score rank: #%d\n", score_rank);
+    if (pacer.skipped > 0)
+        printf("Frames: %llu simulated, %llu dropped, %llu drawn\n",
+               (unsigned long long)pacer.frames, (unsigned long long)pacer.skipped,
+               (unsigned long long)display.drawn);
 
     return 0;
 }
@@ -0,0 +1,248 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "metrics.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+/* Upper bounds of all but the +Inf bucket, microseconds */
+static const uint64_t BUCKET_US[METRICS_BUCKETS - 1] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000
+};
+
+static const char *const STATE_NAMES[] = { "init", "running", "paused", "gameover", "quit" };
+
+#define REPLY_MAX 8192
+
+void metrics_init(Metrics *m) {
+    memset(m, 0, sizeof(*m));
+}
+
+void metrics_game_frame(Metrics *m, const Game *g, unsigned inputs, uint64_t dropped) {
+    metrics_add(&m->frames_published, 1);
+    if (inputs)
+        metrics_add(&m->input_events, inputs);
+    metrics_set(&m->frames_dropped, dropped);
+    metrics_set(&m->pieces_locked, g->stats.pieces);
+    metrics_set(&m->state, (uint64_t)g->state);
+    metrics_set(&m->level, (uint64_t)g->level);
+}
+
+void metrics_frame_drawn(Metrics *m, uint64_t draw_ns) {
+    int b = 0;
+    while (b < METRICS_BUCKETS - 1 && draw_ns > BUCKET_US[b] * 1000)
+        b++;
+    metrics_add(&m->draw_buckets[b], 1);
+    metrics_add(&m->draw_ns_sum, draw_ns);
+    metrics_add(&m->frames_drawn, 1);
+}
+
+/* ── Exposition ──────────────────────────────────────────────────── */
+
+static uint64_t load(const uint64_t *v) {
+    return __atomic_load_n(v, __ATOMIC_RELAXED);
+}
+
+/* Bytes the process has passed to write(), from /proc/self/io. */
+static int written_bytes(unsigned long long *out) {
+    FILE *f = fopen("/proc/self/io", "r");
+    if (!f)
+        return 0;
+    char line[128];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f))
+        found = sscanf(line, "wchar: %llu", out) == 1;
+    fclose(f);
+    return found;
+}
+
+typedef struct {
+    char  *buf;
+    size_t len;
+} Reply;
+
+/* Append to the reply; output past REPLY_MAX is cut off. */
+static void emit(Reply *r, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(r->buf + r->len, REPLY_MAX - r->len, fmt, ap);
+    va_end(ap);
+    if (n < 0)
+        return;
+    r->len = r->len + (size_t)n < REPLY_MAX ? r->len + (size_t)n : REPLY_MAX - 1;
+}
+
+static void counter(Reply *r, const char *name, const char *help, uint64_t v) {
+    emit(r, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n",
+         name, help, name, name, (unsigned long long)v);
+}
+
+static void gauge(Reply *r, const char *name, const char *help, uint64_t v) {
+    emit(r, "# HELP %s %s\n# TYPE %s gauge\n%s %llu\n",
+         name, help, name, name, (unsigned long long)v);
+}
+
+static size_t exposition(const Metrics *m, char *buf) {
+    Reply r = { buf, 0 };
+    buf[0] = '\0';
+
+    counter(&r, "termv_frames_published_total", "Frames simulated and handed to the render thread.",
+            load(&m->frames_published));
+    counter(&r, "termv_frames_dropped_total", "Frame deadlines missed by the game loop.",
+            load(&m->frames_dropped));
+    counter(&r, "termv_frames_rendered_total", "Frames drawn to the terminal.",
+            load(&m->frames_drawn));
+
+    /* Cumulative buckets; the count is their total, so they always agree */
+    emit(&r, "# HELP termv_frame_draw_seconds Time to draw and flush one frame.\n"
+             "# TYPE termv_frame_draw_seconds histogram\n");
+    uint64_t cumulative = 0;
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        cumulative += load(&m->draw_buckets[b]);
+        if (b < METRICS_BUCKETS - 1)
+            emit(&r, "termv_frame_draw_seconds_bucket{le=\"%g\"} %llu\n",
+                 BUCKET_US[b] / 1e6, (unsigned long long)cumulative);
+        else
+            emit(&r, "termv_frame_draw_seconds_bucket{le=\"+Inf\"} %llu\n",
+                 (unsigned long long)cumulative);
+    }
+    emit(&r, "termv_frame_draw_seconds_sum %.6f\ntermv_frame_draw_seconds_count %llu\n",
+         load(&m->draw_ns_sum) / 1e9, (unsigned long long)cumulative);
+
+    counter(&r, "termv_input_events_total", "Key actions read from the terminal.",
+            load(&m->input_events));
+    counter(&r, "termv_pieces_locked_total", "Pieces locked this game.",
+            load(&m->pieces_locked));
+    gauge(&r, "termv_level", "Current level.", load(&m->level));
+
+    uint64_t state = load(&m->state);
+    emit(&r, "# HELP termv_state Game state (1 for the current one).\n# TYPE termv_state gauge\n");
+    for (uint64_t i = 0; i < sizeof(STATE_NAMES) / sizeof(*STATE_NAMES); i++)
+        emit(&r, "termv_state{state=\"%s\"} %d\n", STATE_NAMES[i], i == state);
+
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        double cpu = ru.ru_utime.tv_sec + ru.ru_stime.tv_sec
+                   + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+        emit(&r, "# HELP termv_cpu_seconds_total User and system CPU time.\n"
+                 "# TYPE termv_cpu_seconds_total counter\ntermv_cpu_seconds_total %.3f\n", cpu);
+    }
+    unsigned long long written;
+    if (written_bytes(&written))
+        counter(&r, "termv_written_bytes_total",
+                "Bytes written by the process, nearly all of it terminal output.", written);
+    return r.len;
+}
+
+/* ── Server ──────────────────────────────────────────────────────── */
+
+/* MSG_NOSIGNAL: a scraper hanging up must not SIGPIPE the game */
+static void send_all(int fd, const char *p, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0)
+            return;
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+/*
+ * Answer one client. An HTTP request (curl, Prometheus through a socket
+ * proxy) gets a response header; anything else, or nothing within 100 ms
+ * (nc -U), gets the bare text.
+ */
+static void serve_client(const Metrics *m, int fd) {
+    static char body[REPLY_MAX];
+    char request[512];
+    ssize_t got = 0;
+
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 100) > 0)
+        got = read(fd, request, sizeof(request) - 1);
+    size_t len = exposition(m, body);
+
+    if (got >= 4 && memcmp(request, "GET ", 4) == 0) {
+        char header[160];
+        int n = snprintf(header, sizeof(header),
+                         "HTTP/1.0 200 OK\r\n"
+                         "Content-Type: text/plain; version=0.0.4\r\n"
+                         "Content-Length: %zu\r\n\r\n", len);
+        send_all(fd, header, (size_t)n);
+    }
+    send_all(fd, body, len);
+}
+
+static void *serve_main(void *arg) {
+    MetricsServer *s = arg;
+    for (;;) {
+        struct pollfd pfd[2] = { { s->fd, POLLIN, 0 }, { s->wake[0], POLLIN, 0 } };
+        if (poll(pfd, 2, -1) < 0)
+            continue;
+        if (pfd[1].revents)
+            break;
+        int client = accept(s->fd, NULL, NULL);
+        if (client < 0)
+            continue;
+        /* A client that stops reading cannot hold up quitting for long */
+        struct timeval timeout = { 1, 0 };
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        serve_client(s->metrics, client);
+        close(client);
+    }
+    return NULL;
+}
+
+int metrics_serve_start(MetricsServer *s, const char *path, const Metrics *m) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return 0;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    strcpy(s->path, path);
+    s->metrics = m;
+
+    /* Replace a socket left by a crashed session, never a regular file */
+    struct stat st;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path);
+
+    s->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s->fd < 0)
+        return 0;
+    if (bind(s->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0
+        || listen(s->fd, 8) != 0 || pipe(s->wake) != 0) {
+        int err = errno;
+        close(s->fd);
+        errno = err;
+        return 0;
+    }
+    if (pthread_create(&s->thread, NULL, serve_main, s) != 0) {
+        close(s->fd);
+        close(s->wake[0]);
+        close(s->wake[1]);
+        unlink(path);
+        errno = EAGAIN;
+        return 0;
+    }
+    return 1;
+}
+
+void metrics_serve_stop(MetricsServer *s) {
+    close(s->wake[1]);
+    pthread_join(s->thread, NULL);
+    close(s->wake[0]);
+    close(s->fd);
+    unlink(s->path);
+}
@@ -0,0 +1,73 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "game.h"
+
+/*
+ * Live counters served as Prometheus text on a Unix-domain socket
+ * (`termv --metrics PATH`), for a local scraper watching many sessions:
+ *
+ *   curl --unix-socket /run/user/1000/termv.sock http://localhost/metrics
+ *
+ * Each counter has exactly one writer thread, which updates it with a
+ * relaxed atomic store: no locks, no read-modify-write, no allocation in
+ * the game or render loop. The server thread reads them with relaxed
+ * loads when a client connects, and samples process-wide figures (CPU
+ * time, bytes written) from the kernel only then.
+ */
+
+/* Draw-time histogram upper bounds, microseconds (plus +Inf) */
+#define METRICS_BUCKETS 12
+
+typedef struct {
+    /* Game thread */
+    uint64_t frames_published;
+    uint64_t frames_dropped;   /* pacer deadlines missed */
+    uint64_t input_events;
+    uint64_t pieces_locked;
+    uint64_t state;            /* GameState */
+    uint64_t level;
+
+    /* Render thread, on a cache line of its own (which makes the struct
+     * 64-byte aligned, wherever it is declared) */
+    uint64_t frames_drawn __attribute__((aligned(64)));
+    uint64_t draw_ns_sum;
+    uint64_t draw_buckets[METRICS_BUCKETS];  /* per bucket, not cumulative */
+} Metrics;
+
+typedef struct {
+    const Metrics *metrics;
+    char           path[108];  /* sun_path */
+    int            fd;
+    int            wake[2];    /* pipe: closes to stop the thread */
+    pthread_t      thread;
+} MetricsServer;
+
+/* Single writer per field: a plain load and a relaxed store suffice. */
+static inline void metrics_add(uint64_t *counter, uint64_t n) {
+    __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + n,
+                     __ATOMIC_RELAXED);
+}
+
+static inline void metrics_set(uint64_t *gauge, uint64_t v) {
+    __atomic_store_n(gauge, v, __ATOMIC_RELAXED);
+}
+
+void metrics_init(Metrics *m);
+
+/* Game thread, once per frame. */
+void metrics_game_frame(Metrics *m, const Game *g, unsigned inputs, uint64_t dropped);
+
+/* Render thread, once per frame drawn. */
+void metrics_frame_drawn(Metrics *m, uint64_t draw_ns);
+
+/*
+ * Listen on path (a stale socket there is replaced) and serve m from a
+ * background thread. Returns 0 on failure, with errno set.
+ */
+int  metrics_serve_start(MetricsServer *s, const char *path, const Metrics *m);
+void metrics_serve_stop(MetricsServer *s);
+
+#endif
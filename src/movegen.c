@@ -0,0 +1,149 @@
+#include "movegen.h"
+#include <string.h>
+
+#define ROW_MIN  (-3)
+#define ROW_SPAN (BOARD_HEIGHT + 3)
+#define COL_MIN  (-3)
+#define COL_SPAN (BOARD_WIDTH + 3)
+
+static int state_index(const Piece *p) {
+    return (p->rotation * ROW_SPAN + (p->row - ROW_MIN)) * COL_SPAN + (p->col - COL_MIN);
+}
+
+/* Cells a locked piece covers, order-independent */
+static uint64_t cells_key(const Piece *p) {
+    int cells[4][2];
+    unsigned idx[4];
+    piece_get_cells(p, cells);
+    for (int i = 0; i < 4; i++) {
+        idx[i] = (unsigned)(cells[i][0] * BOARD_WIDTH + cells[i][1]);
+        for (int j = i; j > 0 && idx[j - 1] > idx[j]; j--) {
+            unsigned tmp = idx[j];
+            idx[j] = idx[j - 1];
+            idx[j - 1] = tmp;
+        }
+    }
+    return (uint64_t)idx[0] | (uint64_t)idx[1] << 16
+         | (uint64_t)idx[2] << 32 | (uint64_t)idx[3] << 48;
+}
+
+int movegen_placements(const Board *b, PieceType type, RotationSystem rs,
+                       Piece *out, MoveScratch *s) {
+    int head = 0, tail = 0, n = 0;
+
+    /*
+     * Rows above the stack are open air: every (rotation, column) reachable
+     * there is reachable at any height, so a piece whose box is entirely
+     * in the air drops straight to the lowest such row instead of stepping
+     * through each one.
+     */
+    int top = BOARD_HEIGHT;
+    for (int r = 0; r < BOARD_HEIGHT; r++) {
+        if (board_row_bits(b, r)) {
+            top = r;
+            break;
+        }
+    }
+    int air_row = top - 4;
+
+    memset(s->seen, 0, sizeof(s->seen));
+    piece_spawn(&s->queue[0], type, rs);
+    if (!piece_valid(b, &s->queue[0]))
+        return 0;
+    s->seen[state_index(&s->queue[0])] = 1;
+    tail = 1;
+
+    /* Breadth-first over every reachable position */
+    while (head < tail) {
+        Piece cur = s->queue[head++];
+
+        Piece down = cur;
+        down.row = cur.row < air_row ? air_row : cur.row + 1;
+        int resting = !piece_valid(b, &down);
+        if (resting) {
+            uint64_t key = cells_key(&cur);
+            int dup = 0;
+            for (int i = 0; i < n && !dup; i++)
+                dup = s->keys[i] == key;
+            if (!dup) {
+                s->keys[n] = key;
+                out[n++] = cur;
+            }
+        }
+
+        for (int move = 0; move < 5; move++) {
+            Piece next = cur;
+            int ok;
+            switch (move) {
+                case 0:  next.col--; ok = piece_valid(b, &next); break;
+                case 1:  next.col++; ok = piece_valid(b, &next); break;
+                case 2:  next = down; ok = !resting; break;
+                case 3:  ok = piece_try_rotate(b, &next, 1); break;
+                default: ok = piece_try_rotate(b, &next, -1); break;
+            }
+            if (!ok)
+                continue;
+            int idx = state_index(&next);
+            if (!s->seen[idx]) {
+                s->seen[idx] = 1;
+                s->queue[tail++] = next;
+            }
+        }
+    }
+    return n;
+}
+
+int movegen_path(const Board *b, const Piece *from, const Piece *target,
+                 unsigned char *out, int max, MoveScratch *s) {
+    uint64_t goal = cells_key(target);
+    int head = 0, tail = 1;
+
+    if (!piece_valid(b, from))
+        return -1;
+    memset(s->seen, 0, sizeof(s->seen));
+    s->queue[0] = *from;
+    s->parent[0] = -1;
+    s->seen[state_index(from)] = 1;
+
+    /* Breadth-first, one game move per edge, so the first hit is shortest */
+    while (head < tail) {
+        int at = head++;
+        Piece cur = s->queue[at];
+
+        Piece drop = cur;
+        drop.row = piece_ghost_row(b, &cur);
+        if (cells_key(&drop) == goal) {
+            int n = 0;
+            for (int i = at; s->parent[i] >= 0; i = s->parent[i])
+                n++;
+            if (n > max)
+                return -1;
+            for (int i = at, k = n; s->parent[i] >= 0; i = s->parent[i])
+                out[--k] = s->via[i];
+            return n;
+        }
+
+        for (int move = MOVE_LEFT; move <= MOVE_CW; move++) {
+            Piece next = cur;
+            int ok;
+            switch (move) {
+                case MOVE_LEFT:  next.col--; ok = piece_valid(b, &next); break;
+                case MOVE_RIGHT: next.col++; ok = piece_valid(b, &next); break;
+                case MOVE_DOWN:  next.row++; ok = piece_valid(b, &next); break;
+                case MOVE_CCW:   ok = piece_try_rotate(b, &next, 1); break;
+                default:         ok = piece_try_rotate(b, &next, -1); break;
+            }
+            if (!ok)
+                continue;
+            int idx = state_index(&next);
+            if (!s->seen[idx]) {
+                s->seen[idx] = 1;
+                s->queue[tail] = next;
+                s->parent[tail] = (int16_t)at;
+                s->via[tail] = (unsigned char)move;
+                tail++;
+            }
+        }
+    }
+    return -1;
+}
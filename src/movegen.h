@@ -0,0 +1,54 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include <stdint.h>
+#include "piece.h"
+
+/*
+ * Placement generation for searches (perft, perfect-clear finder), and
+ * the moves that carry out a chosen placement.
+ *
+ * A placement is a resting position reachable from spawn by any mix of
+ * shifts, soft drops and rotations (with kicks), so tucks and spins are
+ * included. Positions that cover the same cells are reported once.
+ */
+
+/* Every (rotation, row, col) a piece reference can take */
+#define MOVEGEN_STATES (4 * (BOARD_HEIGHT + 3) * (BOARD_WIDTH + 3))
+
+/* Scratch for one generator call; reuse it between calls. */
+typedef struct {
+    Piece         queue[MOVEGEN_STATES];
+    unsigned char seen[MOVEGEN_STATES];
+    uint64_t      keys[MOVEGEN_STATES];
+    int16_t       parent[MOVEGEN_STATES];  /* movegen_path: queue index reached from */
+    unsigned char via[MOVEGEN_STATES];     /* movegen_path: Move taken */
+} MoveScratch;
+
+/* One step of a path: game_move(0, -1), game_move(0, 1), game_move(1, 0),
+ * game_rotate(1), game_rotate(-1) */
+typedef enum {
+    MOVE_LEFT,
+    MOVE_RIGHT,
+    MOVE_DOWN,
+    MOVE_CCW,
+    MOVE_CW
+} Move;
+
+/*
+ * Write the placements of a type piece on b to out (room for
+ * MOVEGEN_STATES). Returns the count, 0 if the piece cannot spawn.
+ */
+int movegen_placements(const Board *b, PieceType type, RotationSystem rs,
+                       Piece *out, MoveScratch *s);
+
+/*
+ * Shortest sequence of moves taking from to a spot from which a hard drop
+ * covers the same cells as target. Writes at most max moves to out.
+ * Returns the count, -1 if target is unreachable (or the path is longer
+ * than max).
+ */
+int movegen_path(const Board *b, const Piece *from, const Piece *target,
+                 unsigned char *out, int max, MoveScratch *s);
+
+#endif
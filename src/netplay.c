@@ -0,0 +1,596 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "netplay.h"
+#include "game.h"
+#include "board.h"
+#include "input.h"
+#include "display.h"
+#include "pacer.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#define VERSUS_HZ      60
+#define TICK_MS        (1000.0 / VERSUS_HZ)
+#define RING           64      /* ticks of saved state and input history */
+#define MAX_PREDICT    30      /* ticks to run ahead of the opponent before stalling */
+#define PACKET_INPUTS  48      /* most inputs one packet carries */
+#define PACKET_HEADER  30
+#define PACKET_MAX     (PACKET_HEADER + PACKET_INPUTS)
+#define NET_MAGIC      0x504E5654u  /* "TVNP" */
+#define HELLO_MS       100.0        /* resend interval while connecting */
+#define TIMEOUT_MS     5000.0       /* silence before giving up on the peer */
+#define DELAY_SLOTS    1024         /* packets held back by --net-delay */
+#define GARBAGE_COLOR  8            /* drawn with the ghost color pair */
+
+/* Keys for one tick */
+enum {
+    IN_LEFT  = 1,
+    IN_RIGHT = 2,
+    IN_DOWN  = 4,
+    IN_CW    = 8,
+    IN_CCW   = 16,
+    IN_DROP  = 32,
+    IN_HELD  = 64   /* soft drop held */
+};
+
+/* Packet flags */
+#define FLAG_QUIT 1
+
+/* Garbage rows sent for 0-4 lines cleared */
+static const int GARBAGE_SENT[5] = { 0, 0, 1, 2, 4 };
+
+/* Everything a tick changes: saved and restored whole */
+typedef struct {
+    Game     game[2];
+    int      pending[2];  /* garbage rows owed to each player */
+    Rng      holes;       /* garbage hole columns */
+    uint32_t tick;        /* ticks simulated */
+} Match;
+
+typedef struct {
+    double        due;
+    int           len;
+    unsigned char data[PACKET_MAX];
+} Delayed;
+
+typedef struct {
+    Match    now;
+    Match    saved[RING];       /* saved[t % RING]: state before tick t */
+    uint8_t  input[2][RING];    /* per player; remote ticks >= remote_count are predictions */
+    int      local, remote;     /* player indices */
+    uint32_t local_count;       /* local inputs decided: ticks [0, local_count) */
+    uint32_t remote_count;      /* remote inputs received */
+    uint32_t peer_ack;          /* local inputs the peer has */
+    uint32_t checked;           /* confirmed ticks checksummed */
+    uint64_t check[RING];       /* checksum of the state after tick t */
+    uint32_t peer_checked;      /* newest peer checksum compared */
+
+    /* Network */
+    int      fd;
+    Delayed  delayed[DELAY_SLOTS];
+    int      delayed_head, delayed_count;
+    Rng      loss_rng;
+    int      delay_ms, loss_pct;
+    unsigned seed;
+
+    /* Report */
+    uint64_t rollbacks, resimulated, max_depth, stalls;
+    uint64_t sent, lost, desyncs;
+    double   rollback_ms;
+} Session;
+
+/* ── Simulation ──────────────────────────────────────────────────── */
+
+static void apply_input(Game *g, uint8_t in) {
+    g->soft_dropping = (in & IN_HELD) != 0;
+    if (in & IN_LEFT)
+        game_move(g, 0, -1);
+    if (in & IN_RIGHT)
+        game_move(g, 0, 1);
+    if (in & IN_DOWN)
+        game_move(g, 1, 0);
+    if (in & IN_CCW)
+        game_rotate(g, 1);
+    if (in & IN_CW)
+        game_rotate(g, -1);
+    if (in & IN_DROP)
+        game_hard_drop(g);
+}
+
+/* Push owed garbage under player p's stack. */
+static void receive_garbage(Match *m, int p) {
+    Game *g = &m->game[p];
+    int hole = (int)rng_below(&m->holes, BOARD_WIDTH);
+    int topped = board_add_garbage(&g->board, m->pending[p], hole, GARBAGE_COLOR);
+    m->pending[p] = 0;
+
+    /* The falling piece rides up with the stack if it has room */
+    while (!piece_valid(&g->board, &g->current) && g->current.row > 0)
+        g->current.row--;
+    if (topped || !piece_valid(&g->board, &g->current))
+        g->state = STATE_GAMEOVER;
+}
+
+static int match_over(const Match *m) {
+    return m->game[0].state == STATE_GAMEOVER || m->game[1].state == STATE_GAMEOVER;
+}
+
+static void match_tick(Match *m, const uint8_t in[2]) {
+    m->tick++;
+    if (match_over(m))
+        return;
+
+    for (int p = 0; p < 2; p++) {
+        Game *g = &m->game[p];
+        int lines = g->lines;
+        uint32_t pieces = g->stats.pieces;
+
+        apply_input(g, in[p]);
+        game_update(g, TICK_MS);
+        if (g->stats.pieces == pieces)
+            continue;
+
+        /* A piece locked: attack (cancelling owed rows first) or take garbage */
+        int cleared = g->lines - lines;
+        if (cleared > 0) {
+            int attack = GARBAGE_SENT[cleared > 4 ? 4 : cleared];
+            int cancel = attack < m->pending[p] ? attack : m->pending[p];
+            m->pending[p] -= cancel;
+            m->pending[1 - p] += attack - cancel;
+        } else if (m->pending[p] > 0) {
+            receive_garbage(m, p);
+        }
+    }
+}
+
+static uint64_t match_checksum(const Match *m) {
+    uint64_t h = 1469598103934665603ull;
+#define MIX(v) (h = (h ^ (uint64_t)(v)) * 1099511628211ull)
+    for (int p = 0; p < 2; p++) {
+        const Game *g = &m->game[p];
+        MIX(board_hash(&g->board));
+        MIX(g->score);
+        MIX(g->lines);
+        MIX(g->state);
+        MIX(g->current.type);
+        MIX(g->current.rotation);
+        MIX(g->current.row);
+        MIX(g->current.col);
+        MIX(m->pending[p]);
+    }
+    MIX(m->holes.state);
+#undef MIX
+    return h;
+}
+
+/* Opponent input for a tick not yet received: no new presses, same hold */
+static uint8_t predict(const Session *s) {
+    if (s->remote_count == 0)
+        return 0;
+    return s->input[s->remote][(s->remote_count - 1) % RING] & IN_HELD;
+}
+
+/* Save the state, then run tick now.tick. */
+static void simulate(Session *s) {
+    uint32_t t = s->now.tick;
+    s->saved[t % RING] = s->now;
+    if (t >= s->remote_count)
+        s->input[s->remote][t % RING] = predict(s);
+    uint8_t in[2] = { s->input[0][t % RING], s->input[1][t % RING] };
+    match_tick(&s->now, in);
+}
+
+/* Restore the state before tick from and replay up to the present. */
+static void rollback(Session *s, uint32_t from) {
+    double started = util_now_ms();
+    uint32_t end = s->now.tick;
+    s->now = s->saved[from % RING];
+    while (s->now.tick < end)
+        simulate(s);
+
+    s->rollbacks++;
+    s->resimulated += end - from;
+    if (end - from > s->max_depth)
+        s->max_depth = end - from;
+    s->rollback_ms += util_now_ms() - started;
+}
+
+/* Checksum every tick that both players' inputs now confirm. */
+static void checksum_confirmed(Session *s) {
+    uint32_t confirmed = s->remote_count < s->now.tick ? s->remote_count : s->now.tick;
+    for (uint32_t t = s->checked; t < confirmed; t++) {
+        const Match *after = t + 1 == s->now.tick ? &s->now : &s->saved[(t + 1) % RING];
+        s->check[t % RING] = match_checksum(after);
+    }
+    if (confirmed > s->checked)
+        s->checked = confirmed;
+}
+
+/* ── Network ─────────────────────────────────────────────────────── */
+
+static void put32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++)
+        p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void put64(unsigned char *p, uint64_t v) {
+    put32(p, (uint32_t)v);
+    put32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t get32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get64(const unsigned char *p) {
+    return (uint64_t)get32(p) | (uint64_t)get32(p + 4) << 32;
+}
+
+/* Bind local_port and connect to "host:port". Returns the socket, -1 on error. */
+static int net_open(int local_port, const char *remote, struct sockaddr_in *peer) {
+    char host[256];
+    const char *colon = strrchr(remote, ':');
+    if (!colon || colon == remote || (size_t)(colon - remote) >= sizeof(host)) {
+        fprintf(stderr, "termv: --versus needs HOST:PORT, got '%s'\n", remote);
+        return -1;
+    }
+    memcpy(host, remote, (size_t)(colon - remote));
+    host[colon - remote] = '\0';
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    int err = getaddrinfo(host, colon + 1, &hints, &res);
+    if (err != 0) {
+        fprintf(stderr, "termv: %s: %s\n", remote, gai_strerror(err));
+        return -1;
+    }
+    memcpy(peer, res->ai_addr, sizeof(*peer));
+    freeaddrinfo(res);
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons((uint16_t)local_port);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&local, sizeof(local)) != 0
+        || connect(fd, (struct sockaddr *)peer, sizeof(*peer)) != 0) {
+        perror("termv: versus socket");
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+/* Lower (address, port) plays as player 0 on both ends. */
+static int local_player(int fd, const struct sockaddr_in *peer) {
+    struct sockaddr_in self;
+    socklen_t len = sizeof(self);
+    getsockname(fd, (struct sockaddr *)&self, &len);
+    uint32_t a = ntohl(self.sin_addr.s_addr), b = ntohl(peer->sin_addr.s_addr);
+    if (a != b)
+        return a < b ? 0 : 1;
+    return ntohs(self.sin_port) < ntohs(peer->sin_port) ? 0 : 1;
+}
+
+/* Queue a packet behind --net-delay, or drop it for --net-loss. */
+static void net_send(Session *s, const unsigned char *data, int len) {
+    s->sent++;
+    if (s->loss_pct > 0 && (int)rng_below(&s->loss_rng, 100) < s->loss_pct) {
+        s->lost++;
+        return;
+    }
+    if (s->delay_ms <= 0) {
+        if (send(s->fd, data, (size_t)len, 0) < 0) {
+            /* peer not listening yet: the next packet repeats this one */
+        }
+        return;
+    }
+    if (s->delayed_count == DELAY_SLOTS) {
+        s->lost++;
+        return;
+    }
+    Delayed *d = &s->delayed[(s->delayed_head + s->delayed_count++) % DELAY_SLOTS];
+    d->due = util_now_ms() + s->delay_ms;
+    d->len = len;
+    memcpy(d->data, data, (size_t)len);
+}
+
+/* Send delayed packets whose time has come (they leave in order). */
+static void net_flush(Session *s) {
+    double now = util_now_ms();
+    while (s->delayed_count > 0 && s->delayed[s->delayed_head].due <= now) {
+        Delayed *d = &s->delayed[s->delayed_head];
+        if (send(s->fd, d->data, (size_t)d->len, 0) < 0) {
+            /* as above */
+        }
+        s->delayed_head = (s->delayed_head + 1) % DELAY_SLOTS;
+        s->delayed_count--;
+    }
+}
+
+/*
+ * Layout: magic, seed, first input tick, ack (remote inputs received),
+ * confirmed ticks checksummed (u32 each), that tick's checksum (u64),
+ * flags, input count (u8), then one byte per input.
+ */
+static void send_inputs(Session *s, int flags) {
+    unsigned char p[PACKET_MAX];
+    uint32_t first = s->peer_ack;
+    uint32_t count = s->local_count - first;
+    if (count > PACKET_INPUTS)
+        count = PACKET_INPUTS;
+
+    put32(p, NET_MAGIC);
+    put32(p + 4, s->seed);
+    put32(p + 8, first);
+    put32(p + 12, s->remote_count);
+    put32(p + 16, s->checked);
+    put64(p + 20, s->checked > 0 ? s->check[(s->checked - 1) % RING] : 0);
+    p[28] = (unsigned char)flags;
+    p[29] = (unsigned char)count;
+    for (uint32_t i = 0; i < count; i++)
+        p[PACKET_HEADER + i] = s->input[s->local][(first + i) % RING];
+    net_send(s, p, PACKET_HEADER + (int)count);
+}
+
+/*
+ * Take in every pending packet. Returns 1 if any arrived, -1 if the peer
+ * quit or plays a different seed. *from is lowered to the first tick whose
+ * prediction turned out wrong.
+ */
+static int receive_inputs(Session *s, uint32_t *from) {
+    unsigned char p[PACKET_MAX];
+    int got = 0;
+    ssize_t len;
+
+    while ((len = recv(s->fd, p, sizeof(p), 0)) >= 0 || errno == ECONNREFUSED) {
+        if (len < PACKET_HEADER || get32(p) != NET_MAGIC)
+            continue;  /* refused (peer not up yet) or not ours */
+        if (get32(p + 4) != s->seed) {
+            fprintf(stderr, "termv: opponent is playing seed %u, not %u\n", get32(p + 4), s->seed);
+            return -1;
+        }
+        if (p[28] & FLAG_QUIT)
+            return -1;
+        got = 1;
+
+        uint32_t first = get32(p + 8);
+        uint32_t count = p[29];
+        if ((ssize_t)(PACKET_HEADER + count) > len)
+            continue;
+        if (get32(p + 12) > s->peer_ack && get32(p + 12) <= s->local_count)
+            s->peer_ack = get32(p + 12);
+
+        /* Inputs continue ours only if the packet starts at or before the gap */
+        for (uint32_t i = 0; first <= s->remote_count && i < count; i++) {
+            uint32_t t = first + i;
+            if (t < s->remote_count)
+                continue;
+            if (t >= s->now.tick + RING)
+                break;  /* slot still holds an unsimulated tick; resent later */
+            uint8_t v = p[PACKET_HEADER + i];
+            if (t < s->now.tick && s->input[s->remote][t % RING] != v && t < *from)
+                *from = t;
+            s->input[s->remote][t % RING] = v;
+            s->remote_count = t + 1;
+        }
+
+        /* Desync check against our checksum of the same tick */
+        uint32_t peer_checked = get32(p + 16);
+        if (peer_checked > s->peer_checked && peer_checked <= s->checked
+            && s->checked - peer_checked < RING) {
+            if (s->check[(peer_checked - 1) % RING] != get64(p + 20))
+                s->desyncs++;
+            s->peer_checked = peer_checked;
+        }
+    }
+    return got;
+}
+
+/* ── Match loop ──────────────────────────────────────────────────── */
+
+/* Fold one key into this tick's input bits. Returns 0 on quit. */
+static int read_key(InputAction action, uint8_t *bits, unsigned *theme_cycles) {
+    switch (action) {
+        case ACTION_LEFT:       *bits |= IN_LEFT; break;
+        case ACTION_RIGHT:      *bits |= IN_RIGHT; break;
+        case ACTION_DOWN:       *bits |= IN_DOWN; break;
+        case ACTION_ROTATE_CW:  *bits |= IN_CW; break;
+        case ACTION_ROTATE_CCW: *bits |= IN_CCW; break;
+        case ACTION_HARD_DROP:  *bits |= IN_DROP; break;
+        case ACTION_THEME:      (*theme_cycles)++; break;
+        case ACTION_QUIT:       return 0;
+        default:                break;  /* no pausing a match */
+    }
+    return 1;
+}
+
+/* Wait for the first packet from the peer. Returns 0 if it never came. */
+static int connect_peer(Session *s, const char *remote) {
+    printf("termv: waiting for %s (Ctrl-C to give up)\n", remote);
+    fflush(stdout);
+
+    double last_sent = -HELLO_MS;
+    uint32_t from = UINT32_MAX;
+    for (;;) {
+        double now = util_now_ms();
+        if (now - last_sent >= HELLO_MS) {
+            send_inputs(s, 0);
+            last_sent = now;
+        }
+        net_flush(s);
+        int got = receive_inputs(s, &from);
+        if (got != 0)
+            return got > 0;
+        struct timespec nap = { 0, 5 * 1000000L };
+        nanosleep(&nap, NULL);
+    }
+}
+
+static void match_init(Session *s, const NetplayOptions *opt) {
+    for (int p = 0; p < 2; p++) {
+        game_init(&s->now.game[p], opt->seed);
+        game_set_rotation(&s->now.game[p], opt->rotation);
+    }
+    rng_seed(&s->now.holes, opt->seed ^ 0x6A09E667u);
+
+    /* Input delay: the first ticks have no local keys */
+    int delay = opt->input_delay;
+    if (delay < 0)
+        delay = 0;
+    if (delay > MAX_PREDICT / 2)
+        delay = MAX_PREDICT / 2;
+    s->local_count = (uint32_t)delay;
+}
+
+int netplay_run(const NetplayOptions *opt) {
+    Session *s = calloc(1, sizeof(*s));
+    if (!s) {
+        fprintf(stderr, "termv: out of memory\n");
+        return 1;
+    }
+    struct sockaddr_in peer;
+    s->fd = net_open(opt->local_port, opt->remote, &peer);
+    if (s->fd < 0) {
+        free(s);
+        return 1;
+    }
+    s->local = local_player(s->fd, &peer);
+    s->remote = 1 - s->local;
+    s->seed = opt->seed;
+    s->delay_ms = opt->delay_ms;
+    s->loss_pct = opt->loss_pct;
+    rng_seed(&s->loss_rng, (uint32_t)time(NULL) ^ (uint32_t)getpid());
+    match_init(s, opt);
+
+    if (!connect_peer(s, opt->remote)) {
+        close(s->fd);
+        free(s);
+        return 1;
+    }
+
+    Display display;
+    if (!display_init(&display)) {
+        fprintf(stderr, "termv: cannot set up the display\n");
+        close(s->fd);
+        free(s);
+        return 1;
+    }
+    render_init();
+    display_start(&display);
+
+    FramePacer pacer;
+    pacer_init(&pacer, VERSUS_HZ);
+    int periods = 1;
+    uint8_t keys = 0;            /* presses not yet given to a tick */
+    double soft_drop_last_seen = 0.0;
+    int soft_drop_active = 0;
+    unsigned theme_cycles = 0;
+    double last_heard = util_now_ms();
+    int peer_gone = 0, quit = 0;
+
+    while (!quit && !peer_gone) {
+        double now = util_now_ms();
+
+        /* Local keys */
+        InputAction action;
+        while ((action = input_poll()) != ACTION_NONE) {
+            if (action == ACTION_DOWN) {
+                soft_drop_active = 1;
+                soft_drop_last_seen = now;
+            }
+            if (!read_key(action, &keys, &theme_cycles))
+                quit = 1;
+        }
+        if (soft_drop_active && now - soft_drop_last_seen > SOFT_DROP_TIMEOUT_MS)
+            soft_drop_active = 0;
+
+        /* Remote inputs, correcting mispredictions */
+        uint32_t from = UINT32_MAX;
+        int got = receive_inputs(s, &from);
+        if (got < 0)
+            peer_gone = 1;
+        else if (got > 0)
+            last_heard = now;
+        else if (now - last_heard > TIMEOUT_MS)
+            peer_gone = 1;
+        if (from < s->now.tick)
+            rollback(s, from);
+
+        /* One tick per elapsed frame, unless too far ahead of the peer */
+        for (int k = 0; k < periods; k++) {
+            if (s->now.tick >= s->remote_count + MAX_PREDICT
+                || s->local_count - s->peer_ack >= PACKET_INPUTS) {
+                s->stalls++;
+                break;
+            }
+            uint8_t in = keys | (soft_drop_active ? IN_HELD : 0);
+            keys = 0;
+            s->input[s->local][s->local_count % RING] = in;
+            s->local_count++;
+            simulate(s);
+        }
+        checksum_confirmed(s);
+        send_inputs(s, 0);
+        net_flush(s);
+
+        Frame *frame = display_frame(&display);
+        memset(frame, 0, sizeof(*frame));
+        frame->game = s->now.game[s->local];
+        frame->versus = 1;
+        frame->opponent = s->now.game[s->remote];
+        frame->theme_cycles = theme_cycles;
+        display_publish(&display);
+
+        periods = pacer_wait(&pacer);
+    }
+
+    /* Send what is still held back, then tell the peer a few times */
+    for (int i = 0; i < s->delayed_count; i++)
+        s->delayed[(s->delayed_head + i) % DELAY_SLOTS].due = 0.0;
+    net_flush(s);
+    s->delay_ms = 0;
+    s->loss_pct = 0;
+    for (int i = 0; i < 3 && quit; i++)
+        send_inputs(s, FLAG_QUIT);
+
+    display_stop(&display);
+    render_cleanup();
+    display_free(&display);
+    close(s->fd);
+
+    const Game *me = &s->now.game[s->local], *them = &s->now.game[s->remote];
+    if (me->state == STATE_GAMEOVER)
+        printf("You lost. ");
+    else if (them->state == STATE_GAMEOVER)
+        printf("You won! ");
+    else
+        printf(peer_gone && !quit ? "Opponent left. " : "Match abandoned. ");
+    printf("Score: %d | Lines: %d | Opponent: %d\n", me->score, me->lines, them->score);
+    printf("Ticks: %u | Rollbacks: %llu (%llu ticks re-simulated, deepest %llu, %.3f ms avg) | Stalls: %llu\n",
+           s->now.tick, (unsigned long long)s->rollbacks, (unsigned long long)s->resimulated,
+           (unsigned long long)s->max_depth,
+           s->rollbacks ? s->rollback_ms / (double)s->rollbacks : 0.0,
+           (unsigned long long)s->stalls);
+    printf("Packets: %llu sent, %llu dropped | Desyncs: %llu\n",
+           (unsigned long long)s->sent, (unsigned long long)s->lost,
+           (unsigned long long)s->desyncs);
+
+    int status = s->desyncs > 0;
+    free(s);
+    return status;
+}
@@ -0,0 +1,41 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include "piece.h"
+
+/*
+ * Two-player versus over UDP (`termv --versus PORT HOST:PORT`), kept in
+ * sync by rollback in the style of GGPO.
+ *
+ * Both clients simulate both games in fixed 60 Hz ticks from the same
+ * seed; a tick's only inputs are the two players' key bits. Local input is
+ * applied at once (after an optional fixed input delay); the opponent's
+ * input for ticks not yet received is predicted. The whole match state is
+ * a plain struct, so it is saved every tick with one copy. When a remote
+ * input arrives that differs from the prediction, the state saved before
+ * that tick is restored and the ticks since are re-simulated within the
+ * same frame.
+ *
+ * Every packet carries all of the sender's inputs the peer has not
+ * acknowledged, so lost packets are covered by the next one, plus a
+ * checksum of the newest fully confirmed tick to detect desyncs.
+ *
+ * Clearing 2/3/4 lines sends 1/2/4 garbage rows (added with
+ * board_add_garbage when the opponent next locks a piece without
+ * clearing); garbage received first cancels garbage owed.
+ */
+
+typedef struct {
+    unsigned int   seed;         /* must match on both sides */
+    RotationSystem rotation;
+    int            local_port;
+    const char    *remote;       /* "host:port" */
+    int            input_delay;  /* ticks before local input applies */
+    int            delay_ms;     /* added to every outgoing packet */
+    int            loss_pct;     /* outgoing packets dropped, 0-100 */
+} NetplayOptions;
+
+/* Play a match in the terminal. Returns a process exit status. */
+int netplay_run(const NetplayOptions *opt);
+
+#endif
@@ -0,0 +1,83 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "pacer.h"
+#include <errno.h>
+#include <unistd.h>
+
+#define NS_PER_SEC 1000000000L
+
+/* ── Timespec helpers ────────────────────────────────────────────── */
+
+static void ts_add_ns(struct timespec *t, long ns) {
+    t->tv_nsec += ns;
+    while (t->tv_nsec >= NS_PER_SEC) {
+        t->tv_nsec -= NS_PER_SEC;
+        t->tv_sec++;
+    }
+}
+
+/* a - b in nanoseconds */
+static int64_t ts_diff_ns(const struct timespec *a, const struct timespec *b) {
+    return (int64_t)(a->tv_sec - b->tv_sec) * NS_PER_SEC + (a->tv_nsec - b->tv_nsec);
+}
+
+/* Sleep until an absolute CLOCK_MONOTONIC time. */
+static void sleep_until(const struct timespec *deadline) {
+#if defined(_POSIX_CLOCK_SELECTION) && _POSIX_CLOCK_SELECTION > 0
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL) == EINTR)
+        ;
+#else
+    /* No clock_nanosleep (macOS): sleep the remaining interval instead */
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t left = ts_diff_ns(deadline, &now);
+    if (left > 0) {
+        struct timespec req = { (time_t)(left / NS_PER_SEC), (long)(left % NS_PER_SEC) };
+        while (nanosleep(&req, &req) != 0 && errno == EINTR)
+            ;
+    }
+#endif
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+void pacer_init(FramePacer *p, int hz) {
+    if (hz < PACER_MIN_HZ)
+        hz = PACER_MIN_HZ;
+    if (hz > PACER_MAX_HZ)
+        hz = PACER_MAX_HZ;
+    p->period_ns = NS_PER_SEC / hz;
+    p->frames = 0;
+    p->skipped = 0;
+    pacer_reset(p);
+}
+
+void pacer_reset(FramePacer *p) {
+    clock_gettime(CLOCK_MONOTONIC, &p->deadline);
+    ts_add_ns(&p->deadline, p->period_ns);
+}
+
+int pacer_wait(FramePacer *p) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    /* Drop every deadline already behind us, keeping the original phase */
+    int periods = 1;
+    int64_t late = ts_diff_ns(&now, &p->deadline);
+    if (late >= p->period_ns) {
+        int64_t missed = late / p->period_ns;
+        p->skipped += (uint64_t)missed;
+        periods += (int)missed;
+        ts_add_ns(&p->deadline, (long)(missed * p->period_ns % NS_PER_SEC));
+        p->deadline.tv_sec += (time_t)(missed * p->period_ns / NS_PER_SEC);
+    }
+
+    sleep_until(&p->deadline);
+    ts_add_ns(&p->deadline, p->period_ns);
+    p->frames++;
+    return periods;
+}
+
+double pacer_period_ms(const FramePacer *p) {
+    return p->period_ns / 1000000.0;
+}
@@ -0,0 +1,40 @@
+#ifndef PACER_H
+#define PACER_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define PACER_MIN_HZ     30
+#define PACER_MAX_HZ     240
+#define PACER_DEFAULT_HZ 60
+
+/*
+ * Frame scheduler. Deadlines are absolute points on the monotonic clock,
+ * spaced exactly one period apart, so time spent drawing a frame never
+ * shifts the next one and sleep overshoot does not accumulate. When a
+ * frame runs past one or more whole deadlines those frames are dropped
+ * (and counted) rather than rendered late in a burst.
+ */
+typedef struct {
+    struct timespec deadline;  /* start of the next frame */
+    long     period_ns;
+    uint64_t frames;           /* frames started */
+    uint64_t skipped;          /* deadlines missed and dropped */
+} FramePacer;
+
+/* hz is clamped to PACER_MIN_HZ..PACER_MAX_HZ. */
+void   pacer_init(FramePacer *p, int hz);
+
+/* Restart the schedule from now (after a long stall). */
+void   pacer_reset(FramePacer *p);
+
+/*
+ * Sleep until the next frame deadline. Returns the number of frame periods
+ * elapsed since the previous frame: 1 normally, more if frames were dropped.
+ */
+int    pacer_wait(FramePacer *p);
+
+/* Frame period in milliseconds. */
+double pacer_period_ms(const FramePacer *p);
+
+#endif
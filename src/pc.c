@@ -0,0 +1,263 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "pc.h"
+#include "board.h"
+#include "movegen.h"
+#include "ttable.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* Boards expanded across all threads before a query gives up */
+#define PC_NODE_LIMIT 100000
+
+/* Transposition table size per query */
+#define PC_TABLE_MB 8
+
+typedef struct {
+    const PieceType *queue;
+    int              count;    /* pieces the clear uses */
+    RotationSystem   rotation;
+    TTable           table;
+
+    /* First-piece placements, handed out to workers in order */
+    Piece           *roots;
+    int              root_count;
+    int              next_root;
+    Board            start;
+    int              height;
+
+    int              found;    /* set once by the winning worker */
+    int              stop;     /* found or over budget */
+    long             nodes;
+    Piece            solution[PC_MAX_PIECES];
+} Search;
+
+typedef struct {
+    Search     *s;
+    MoveScratch scratch;
+    Piece       moves[PC_MAX_PIECES][MOVEGEN_STATES];
+    Piece       path[PC_MAX_PIECES];
+    long        nodes;     /* not yet added to s->nodes */
+} Worker;
+
+/* ── Pruning ─────────────────────────────────────────────────────── */
+
+/* Each enclosed empty region in the bottom height rows must hold whole pieces. */
+static int regions_fillable(const Board *b, int height) {
+    unsigned empty[PC_MAX_HEIGHT];
+    unsigned full = (1u << BOARD_WIDTH) - 1;
+    int base = BOARD_HEIGHT - height;
+
+    for (int r = 0; r < height; r++)
+        empty[r] = ~board_row_bits(b, base + r) & full;
+
+    for (int r = 0; r < height; r++) {
+        while (empty[r]) {
+            /* Flood fill from the lowest set bit, clearing cells as they are counted */
+            int stack[PC_MAX_HEIGHT * BOARD_WIDTH][2];
+            int sp = 0, size = 0;
+            int c = __builtin_ctz(empty[r]);
+            empty[r] &= ~(1u << c);
+            stack[sp][0] = r;
+            stack[sp++][1] = c;
+            while (sp > 0) {
+                sp--;
+                int cr = stack[sp][0], cc = stack[sp][1];
+                size++;
+                static const int DIRS[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+                for (int d = 0; d < 4; d++) {
+                    int nr = cr + DIRS[d][0], nc = cc + DIRS[d][1];
+                    if (nr < 0 || nr >= height || nc < 0 || nc >= BOARD_WIDTH)
+                        continue;
+                    if (empty[nr] & (1u << nc)) {
+                        empty[nr] &= ~(1u << nc);
+                        stack[sp][0] = nr;
+                        stack[sp++][1] = nc;
+                    }
+                }
+            }
+            if (size % 4 != 0)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Lock p into a copy of b and clear lines. Returns the remaining clear
+ * height, or -1 if p pokes out of the rows being cleared or leaves an
+ * unfillable region.
+ */
+static int place(const Board *b, const Piece *p, int height, Board *out) {
+    int cells[4][2];
+    piece_get_cells(p, cells);
+    for (int i = 0; i < 4; i++) {
+        if (cells[i][0] < BOARD_HEIGHT - height)
+            return -1;
+    }
+
+    *out = *b;
+    board_lock(out, cells, piece_color(p->type));
+    height -= board_clear_lines(out);
+    if (height > 0 && !regions_fillable(out, height))
+        return -1;
+    return height;
+}
+
+/* ── Search ──────────────────────────────────────────────────────── */
+
+/* A board dead at one clear height may not be at another: key them apart */
+static uint64_t state_key(const Board *b, int placed, int height) {
+    return board_hash(b) ^ ((uint64_t)placed + 1) * 0x9E3779B97F4A7C15ull
+                         ^ (uint64_t)height * 0xC2B2AE3D27D4EB4Full;
+}
+
+static int over_budget(Worker *w) {
+    if (++w->nodes < 256)
+        return __atomic_load_n(&w->s->stop, __ATOMIC_RELAXED);
+    long total = __atomic_add_fetch(&w->s->nodes, w->nodes, __ATOMIC_RELAXED);
+    w->nodes = 0;
+    if (total > PC_NODE_LIMIT)
+        __atomic_store_n(&w->s->stop, 1, __ATOMIC_RELAXED);
+    return __atomic_load_n(&w->s->stop, __ATOMIC_RELAXED);
+}
+
+/* Depth-first from b with `placed` pieces down. Returns 1 once path holds a clear. */
+static int dfs(Worker *w, const Board *b, int placed, int height) {
+    Search *s = w->s;
+    if (over_budget(w))
+        return 0;
+
+    Piece *moves = w->moves[placed];
+    int n = movegen_placements(b, s->queue[placed], s->rotation, moves, &w->scratch);
+    for (int i = 0; i < n; i++) {
+        Board child;
+        int left = place(b, &moves[i], height, &child);
+        if (left < 0)
+            continue;
+        w->path[placed] = moves[i];
+        if (left == 0)
+            return 1;  /* only possible with the last piece */
+        if (placed + 1 == s->count)
+            continue;
+        if (ttable_insert(&s->table, state_key(&child, placed + 1, s->height)) == 0)
+            continue;  /* already searched */
+        if (dfs(w, &child, placed + 1, left))
+            return 1;
+    }
+    return 0;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    Search *s = w->s;
+
+    for (;;) {
+        int i = __atomic_fetch_add(&s->next_root, 1, __ATOMIC_RELAXED);
+        if (i >= s->root_count || __atomic_load_n(&s->stop, __ATOMIC_RELAXED))
+            break;
+
+        Board child;
+        int left = place(&s->start, &s->roots[i], s->height, &child);
+        if (left < 0)
+            continue;
+        w->path[0] = s->roots[i];
+        int ok = left == 0
+              || (s->count > 1 && dfs(w, &child, 1, left));
+        if (ok && __atomic_exchange_n(&s->found, 1, __ATOMIC_ACQ_REL) == 0) {
+            memcpy(s->solution, w->path, sizeof(s->solution));
+            __atomic_store_n(&s->stop, 1, __ATOMIC_RELEASE);
+        }
+    }
+    return NULL;
+}
+
+/* One threaded search for a clear of exactly height rows using count pieces. */
+static int search_height(Search *s, Worker *workers, int threads) {
+    pthread_t tids[UTIL_MAX_THREADS];
+    int started = 0;
+
+    s->next_root = 0;
+    s->found = 0;
+    s->stop = 0;
+    s->nodes = 0;
+
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, worker_main, &workers[i]) != 0)
+            break;
+        started = i;
+    }
+    worker_main(&workers[0]);
+    for (int i = 1; i <= started; i++)
+        pthread_join(tids[i], NULL);
+    return s->found;
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+int pc_find(const Board *b, const PieceType *queue, int n, RotationSystem rs,
+            int threads, Piece *out) {
+    if (n > PC_MAX_PIECES)
+        n = PC_MAX_PIECES;
+    threads = util_thread_count(threads);
+
+    /* Filled cells and stack height */
+    int filled = 0, stack = 0;
+    for (int r = 0; r < BOARD_HEIGHT; r++) {
+        unsigned bits = board_row_bits(b, r);
+        if (bits && !stack)
+            stack = BOARD_HEIGHT - r;
+        filled += __builtin_popcount(bits);
+    }
+    if (stack > PC_MAX_HEIGHT || n < 1)
+        return 0;
+
+    Search s;
+    memset(&s, 0, sizeof(s));
+    s.queue = queue;
+    s.rotation = rs;
+    s.start = *b;
+    s.roots = malloc(MOVEGEN_STATES * sizeof(*s.roots));
+    Worker *workers = malloc((size_t)threads * sizeof(*workers));
+    int ok = s.roots && workers && ttable_init(&s.table, PC_TABLE_MB);
+    int length = 0;
+
+    for (int i = 0; ok && i < threads; i++) {
+        workers[i].s = &s;
+        workers[i].nodes = 0;
+    }
+    if (ok)
+        s.root_count = movegen_placements(b, queue[0], rs, s.roots, &workers[0].scratch);
+
+    /* Lowest clear first: height h needs (10h - filled) / 4 pieces */
+    for (int h = stack > 0 ? stack : 1; ok && h <= PC_MAX_HEIGHT; h++) {
+        int cells = h * BOARD_WIDTH - filled;
+        if (cells <= 0 || cells % 4 != 0 || cells / 4 > n)
+            continue;
+        s.height = h;
+        s.count = cells / 4;
+        if (search_height(&s, workers, threads)) {
+            length = s.count;
+            memcpy(out, s.solution, (size_t)length * sizeof(*out));
+            break;
+        }
+    }
+
+    ttable_free(&s.table);
+    free(s.roots);
+    free(workers);
+    return length;
+}
+
+int pc_find_game(const Game *g, int threads, Piece *out) {
+    PieceType queue[PC_MAX_PIECES];
+    int n = 0;
+
+    queue[n++] = g->current.type;
+    queue[n++] = g->next;
+    for (int i = g->bag_index; i < 7 && n < PC_MAX_PIECES; i++)
+        queue[n++] = g->bag[i];
+    return pc_find(&g->board, queue, n, g->rotation, threads, out);
+}
@@ -0,0 +1,32 @@
+#ifndef PC_H
+#define PC_H
+
+#include "game.h"
+
+/*
+ * Perfect-clear finder: a sequence of placements for the upcoming pieces,
+ * in order (there is no hold), that leaves the board completely empty.
+ *
+ * The search tries the lowest clear height first. Every placement must
+ * stay inside the rows being cleared, and branches where an enclosed empty
+ * region cannot be filled by whole tetrominoes are cut. Worker threads split
+ * the first piece's placements and run depth-first, sharing a lock-free
+ * transposition table keyed on the board's occupancy hash, so a position
+ * proven dead by one thread is never searched again by another.
+ */
+
+#define PC_MAX_PIECES 9  /* current, next and a full bag */
+#define PC_MAX_HEIGHT 6  /* tallest clear searched, in rows */
+
+/*
+ * Search for placements of queue[0..n-1] that empty b. Returns the number
+ * of placements written to out (1..n), or 0 if there is no perfect clear
+ * or the search ran over its node budget. threads <= 0 uses every CPU.
+ */
+int pc_find(const Board *b, const PieceType *queue, int n, RotationSystem rs,
+            int threads, Piece *out);
+
+/* pc_find() for a game in progress: current, next, then the rest of the bag. */
+int pc_find_game(const Game *g, int threads, Piece *out);
+
+#endif
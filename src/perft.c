@@ -0,0 +1,202 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "perft.h"
+#include "board.h"
+#include "game.h"
+#include "movegen.h"
+#include "ttable.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* Board after ply pieces, as a table key */
+static uint64_t board_key(const Board *b, int ply) {
+    return board_hash(b) ^ ((uint64_t)ply + 1) * 0x9E3779B97F4A7C15ull;
+}
+
+/* ── Search ──────────────────────────────────────────────────────── */
+
+typedef struct {
+    const PerftOptions *opt;
+    const PieceType    *pieces;
+    TTable             *table;
+
+    /* Per-ply scratch and counters */
+    Piece         (*moves)[MOVEGEN_STATES];
+    MoveScratch   *scratch;
+    uint64_t      boards[PERFT_MAX_DEPTH];      /* distinct boards after ply+1 pieces */
+    uint64_t      placements[PERFT_MAX_DEPTH];  /* placements generated for piece ply */
+
+    /* Serial phase: boards at split_ply are queued instead of searched */
+    int    split_ply;
+    Board *work;
+    size_t work_count;
+    size_t work_cap;
+    int    oom;
+
+    /* Parallel phase */
+    size_t *next_work;
+} Worker;
+
+static void queue_work(Worker *w, const Board *b) {
+    if (w->work_count == w->work_cap) {
+        size_t cap = w->work_cap ? w->work_cap * 2 : 64;
+        Board *grown = realloc(w->work, cap * sizeof(*grown));
+        if (!grown) {
+            w->oom = 1;
+            return;
+        }
+        w->work = grown;
+        w->work_cap = cap;
+    }
+    w->work[w->work_count++] = *b;
+}
+
+static void search(Worker *w, const Board *b, int ply) {
+    Piece *moves = w->moves[ply];
+    int n = movegen_placements(b, w->pieces[ply], w->opt->rotation, moves, w->scratch);
+    w->placements[ply] += (uint64_t)n;
+
+    for (int i = 0; i < n; i++) {
+        Board child = *b;
+        int cells[4][2];
+        piece_get_cells(&moves[i], cells);
+        board_lock(&child, cells, piece_color(moves[i].type));
+        board_clear_lines(&child);
+
+        if (ttable_insert(w->table, board_key(&child, ply + 1)) != 1)
+            continue;
+        w->boards[ply]++;
+
+        if (ply + 1 == w->split_ply)
+            queue_work(w, &child);
+        else if (ply + 1 < w->opt->depth)
+            search(w, &child, ply + 1);
+    }
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = arg;
+    for (;;) {
+        size_t i = __atomic_fetch_add(w->next_work, 1, __ATOMIC_RELAXED);
+        if (i >= w->work_count)
+            break;
+        search(w, &w->work[i], w->split_ply);
+    }
+    return NULL;
+}
+
+static int worker_alloc(Worker *w, const Worker *proto) {
+    *w = *proto;
+    memset(w->boards, 0, sizeof(w->boards));
+    memset(w->placements, 0, sizeof(w->placements));
+    w->moves = malloc((size_t)proto->opt->depth * sizeof(*w->moves));
+    w->scratch = malloc(sizeof(*w->scratch));
+    return w->moves && w->scratch;
+}
+
+static void worker_free(Worker *w) {
+    free(w->moves);
+    free(w->scratch);
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+int perft_run(const PerftOptions *opt) {
+    if (opt->depth < 1 || opt->depth > PERFT_MAX_DEPTH) {
+        fprintf(stderr, "termv: perft depth must be 1-%d\n", PERFT_MAX_DEPTH);
+        return 1;
+    }
+
+    int threads = util_thread_count(opt->threads);
+
+    TTable table;
+    int ok = ttable_init(&table, opt->table_mb);
+
+    PieceType pieces[PERFT_MAX_DEPTH];
+    bag_sequence(opt->seed, 0, pieces, (size_t)opt->depth);
+
+    Worker proto;
+    memset(&proto, 0, sizeof(proto));
+    proto.opt = opt;
+    proto.pieces = pieces;
+    proto.table = &table;
+    proto.split_ply = opt->depth >= 3 ? 2 : -1;
+
+    Worker *workers = calloc((size_t)threads, sizeof(*workers));
+    ok = ok && workers;
+    for (int i = 0; ok && i < threads; i++)
+        ok = worker_alloc(&workers[i], &proto);
+    if (!ok) {
+        fprintf(stderr, "termv: out of memory\n");
+        return 1;
+    }
+
+    double start = util_now_seconds();
+
+    /* Serial phase: expand the first plies on worker 0, queueing split_ply boards */
+    Board empty;
+    board_init(&empty);
+    Worker *w0 = &workers[0];
+    search(w0, &empty, 0);
+    if (w0->oom) {
+        fprintf(stderr, "termv: out of memory\n");
+        return 1;
+    }
+
+    /* Parallel phase: workers pull queued boards until none are left */
+    size_t next_work = 0;
+    pthread_t *tids = calloc((size_t)threads, sizeof(*tids));
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        workers[i].work = w0->work;
+        workers[i].work_count = w0->work_count;
+        workers[i].split_ply = w0->split_ply;
+        workers[i].next_work = &next_work;
+    }
+    for (int i = 1; tids && i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, worker_main, &workers[i]) != 0)
+            break;
+        started = i;
+    }
+    worker_main(&workers[0]);
+    for (int i = 1; i <= started; i++)
+        pthread_join(tids[i], NULL);
+
+    double elapsed = util_now_seconds() - start;
+
+    if (table.full) {
+        fprintf(stderr, "termv: perft transposition table full, retry with a larger --tt-mb\n");
+        return 1;
+    }
+
+    uint64_t total_boards = 0, total_placements = 0;
+    printf("perft seed %u depth %d (%s rotation, %d thread%s)\n",
+           opt->seed, opt->depth, rotation_system_name(opt->rotation),
+           threads, threads == 1 ? "" : "s");
+    printf("%4s  %5s  %14s  %14s\n", "ply", "piece", "boards", "placements");
+    for (int ply = 0; ply < opt->depth; ply++) {
+        uint64_t boards = 0, placements = 0;
+        for (int i = 0; i < threads; i++) {
+            boards += workers[i].boards[ply];
+            placements += workers[i].placements[ply];
+        }
+        total_boards += boards;
+        total_placements += placements;
+        printf("%4d  %5c  %14llu  %14llu\n", ply + 1, PIECE_LETTERS[pieces[ply]],
+               (unsigned long long)boards, (unsigned long long)placements);
+    }
+    printf("%llu placements, %llu distinct boards in %.3f s (%.0f placements/s)\n",
+           (unsigned long long)total_placements, (unsigned long long)total_boards,
+           elapsed, elapsed > 0.0 ? total_placements / elapsed : 0.0);
+
+    for (int i = 0; i < threads; i++)
+        worker_free(&workers[i]);
+    free(w0->work);
+    free(workers);
+    free(tids);
+    ttable_free(&table);
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "piece.h"
+
+/*
+ * Placement-tree counter (`termv --perft SEED DEPTH`), after the chess
+ * engine tool of the same name. Starting from an empty board it places
+ * the first DEPTH pieces dealt for SEED in every reachable way (shifts,
+ * rotations with kicks, soft drops, so tucks and spins count) and reports
+ * how many distinct boards exist after each piece.
+ *
+ * Move generation runs on piece_valid, piece_try_rotate, board_lock and
+ * board_clear_lines, so the counts are a fixed oracle for those functions
+ * and the run time is a benchmark of them. The tree is searched depth-first
+ * by worker threads sharing a lock-free transposition table keyed on the
+ * board's occupancy hash and ply: each distinct board is expanded once.
+ */
+
+#define PERFT_MAX_DEPTH 16
+
+typedef struct {
+    unsigned int   seed;
+    int            depth;
+    int            threads;  /* 0 = one per online CPU */
+    int            table_mb; /* transposition table size */
+    RotationSystem rotation;
+} PerftOptions;
+
+/* Run and print the report to stdout. Returns a process exit status. */
+int perft_run(const PerftOptions *opt);
+
+#endif
@@ -1,13 +1,19 @@
 #include "piece.h"
-#include "board.h"
+#include <string.h>
 
 /*
- * Tetromino definitions: 4 rotation states each, stored as 4 (row, col)
- * offsets relative to the piece's top-left origin in a 4x4 bounding box.
+ * Rotation systems. Each one is a shape table and a kick table, both flat
+ * arrays built into the binary: shapes are indexed by (type, rotation) and
+ * kick lists by (type, from-rotation, direction), so rotating is one table
+ * walk with no per-piece special cases in code.
  *
- * Rotation 0 = spawn (North), 1 = East (CW), 2 = South, 3 = West (CCW).
+ * Shapes are 4 (row, col) offsets from the piece's top-left origin in a
+ * 4x4 bounding box. Rotation 0 is the spawn state and each +1 is a quarter
+ * turn counter-clockwise, so 1 = West (L), 2 = South, 3 = East (R).
  */
 
+/* ── Basic: original shapes, same six kicks for every rotation ──── */
+
 /* I-piece */
 static const int I_CELLS[4][4][2] = {
     /* 0: ....  */  {{1,0},{1,1},{1,2},{1,3}},
@@ -65,24 +71,189 @@ static const int L_CELLS[4][4][2] = {
     {{0,0},{0,1},{1,1},{2,1}},   /* CW:  ## / .# / .# */
 };
 
-/* Table of all piece cell data, indexed by PieceType */
-static const int (*PIECE_TABLE[PIECE_COUNT])[4][2] = {
+static const int (*BASIC_SHAPES[PIECE_COUNT])[4][2] = {
     I_CELLS, O_CELLS, T_CELLS, S_CELLS, Z_CELLS, J_CELLS, L_CELLS
 };
 
-/* Wall kick offsets for basic rotation (non-SRS) */
-static const int KICK_OFFSETS[][2] = {
-    { 0,  0},
-    { 0,  1},  /* right */
-    { 0, -1},  /* left */
-    {-1,  0},  /* up */
-    { 0,  2},  /* right 2 */
-    { 0, -2},  /* left 2 */
+/* ── SRS: guideline shapes, 3x3 boxes (I in 4x4) ─────────────────── */
+
+static const int SRS_I_CELLS[4][4][2] = {
+    {{1,0},{1,1},{1,2},{1,3}},   /* 0: .... / #### */
+    {{0,1},{1,1},{2,1},{3,1}},   /* L: column 1 */
+    {{2,0},{2,1},{2,2},{2,3}},   /* 2: row 2 */
+    {{0,2},{1,2},{2,2},{3,2}},   /* R: column 2 */
+};
+
+static const int SRS_T_CELLS[4][4][2] = {
+    {{0,1},{1,0},{1,1},{1,2}},   /* 0: .#. / ### */
+    {{0,1},{1,0},{1,1},{2,1}},   /* L: .#. / ##. / .#. */
+    {{1,0},{1,1},{1,2},{2,1}},   /* 2: ... / ### / .#. */
+    {{0,1},{1,1},{1,2},{2,1}},   /* R: .#. / .## / .#. */
+};
+
+static const int SRS_S_CELLS[4][4][2] = {
+    {{0,1},{0,2},{1,0},{1,1}},   /* 0: .## / ##. */
+    {{0,0},{1,0},{1,1},{2,1}},   /* L: #.. / ##. / .#. */
+    {{1,1},{1,2},{2,0},{2,1}},   /* 2: ... / .## / ##. */
+    {{0,1},{1,1},{1,2},{2,2}},   /* R: .#. / .## / ..# */
+};
+
+static const int SRS_Z_CELLS[4][4][2] = {
+    {{0,0},{0,1},{1,1},{1,2}},   /* 0: ##. / .## */
+    {{0,1},{1,0},{1,1},{2,0}},   /* L: .#. / ##. / #.. */
+    {{1,0},{1,1},{2,1},{2,2}},   /* 2: ... / ##. / .## */
+    {{0,2},{1,1},{1,2},{2,1}},   /* R: ..# / .## / .#. */
+};
+
+static const int SRS_J_CELLS[4][4][2] = {
+    {{0,0},{1,0},{1,1},{1,2}},   /* 0: #.. / ### */
+    {{0,1},{1,1},{2,0},{2,1}},   /* L: .#. / .#. / ##. */
+    {{1,0},{1,1},{1,2},{2,2}},   /* 2: ... / ### / ..# */
+    {{0,1},{0,2},{1,1},{2,1}},   /* R: .## / .#. / .#. */
+};
+
+static const int SRS_L_CELLS[4][4][2] = {
+    {{0,2},{1,0},{1,1},{1,2}},   /* 0: ..# / ### */
+    {{0,0},{0,1},{1,1},{2,1}},   /* L: ##. / .#. / .#. */
+    {{1,0},{1,1},{1,2},{2,0}},   /* 2: ... / ### / #.. */
+    {{0,1},{1,1},{2,1},{2,2}},   /* R: .#. / .#. / .## */
+};
+
+static const int (*SRS_SHAPES[PIECE_COUNT])[4][2] = {
+    SRS_I_CELLS, O_CELLS, SRS_T_CELLS, SRS_S_CELLS, SRS_Z_CELLS, SRS_J_CELLS, SRS_L_CELLS
+};
+
+/* ── ARS: shapes rest on the bottom of a 3x3 box ─────────────────── */
+
+static const int ARS_I_CELLS[4][4][2] = {
+    {{1,0},{1,1},{1,2},{1,3}},
+    {{0,2},{1,2},{2,2},{3,2}},
+    {{1,0},{1,1},{1,2},{1,3}},
+    {{0,2},{1,2},{2,2},{3,2}},
+};
+
+static const int ARS_O_CELLS[4][4][2] = {
+    {{1,1},{1,2},{2,1},{2,2}},
+    {{1,1},{1,2},{2,1},{2,2}},
+    {{1,1},{1,2},{2,1},{2,2}},
+    {{1,1},{1,2},{2,1},{2,2}},
+};
+
+static const int ARS_T_CELLS[4][4][2] = {
+    {{1,0},{1,1},{1,2},{2,1}},   /* 0: ... / ### / .#. */
+    {{0,1},{1,1},{1,2},{2,1}},   /* L: .#. / .## / .#. */
+    {{1,1},{2,0},{2,1},{2,2}},   /* 2: ... / .#. / ### */
+    {{0,1},{1,0},{1,1},{2,1}},   /* R: .#. / ##. / .#. */
+};
+
+static const int ARS_S_CELLS[4][4][2] = {
+    {{1,1},{1,2},{2,0},{2,1}},   /* 0: ... / .## / ##. */
+    {{0,0},{1,0},{1,1},{2,1}},   /* L: #.. / ##. / .#. */
+    {{1,1},{1,2},{2,0},{2,1}},
+    {{0,0},{1,0},{1,1},{2,1}},
 };
-#define NUM_KICKS 6
+
+static const int ARS_Z_CELLS[4][4][2] = {
+    {{1,0},{1,1},{2,1},{2,2}},   /* 0: ... / ##. / .## */
+    {{0,2},{1,1},{1,2},{2,1}},   /* L: ..# / .## / .#. */
+    {{1,0},{1,1},{2,1},{2,2}},
+    {{0,2},{1,1},{1,2},{2,1}},
+};
+
+static const int ARS_J_CELLS[4][4][2] = {
+    {{1,0},{1,1},{1,2},{2,2}},   /* 0: ... / ### / ..# */
+    {{0,1},{0,2},{1,1},{2,1}},   /* L: .## / .#. / .#. */
+    {{1,0},{2,0},{2,1},{2,2}},   /* 2: ... / #.. / ### */
+    {{0,1},{1,1},{2,0},{2,1}},   /* R: .#. / .#. / ##. */
+};
+
+static const int ARS_L_CELLS[4][4][2] = {
+    {{1,0},{1,1},{1,2},{2,0}},   /* 0: ... / ### / #.. */
+    {{0,1},{1,1},{2,1},{2,2}},   /* L: .#. / .#. / .## */
+    {{1,2},{2,0},{2,1},{2,2}},   /* 2: ... / ..# / ### */
+    {{0,0},{0,1},{1,1},{2,1}},   /* R: ##. / .#. / .#. */
+};
+
+static const int (*ARS_SHAPES[PIECE_COUNT])[4][2] = {
+    ARS_I_CELLS, ARS_O_CELLS, ARS_T_CELLS, ARS_S_CELLS, ARS_Z_CELLS, ARS_J_CELLS, ARS_L_CELLS
+};
+
+static const int (*const *SHAPES[ROTATION_COUNT])[4][2] = {
+    BASIC_SHAPES, SRS_SHAPES, ARS_SHAPES
+};
+
+/* ── Kick tables ─────────────────────────────────────────────────── */
+
+/*
+ * KICKS[system][type][from][d] lists the offsets tried in order, with
+ * d = 0 for dir +1 (counter-clockwise) and d = 1 for dir -1 (clockwise).
+ * SRS data is written in the guideline's (x right, y up) notation.
+ */
+#define K(x, y) { -(y), (x) }
+
+#define NO_KICK  { 1, { K(0, 0) } }
+
+#define BASIC_KICKS { 6, { K(0, 0), K(1, 0), K(-1, 0), K(0, 1), K(2, 0), K(-2, 0) } }
+
+/* ARS: in place, then one column right, then one left (I and O never kick) */
+#define ARS_KICKS { 3, { K(0, 0), K(1, 0), K(-1, 0) } }
+
+#define SRS_0R { 5, { K(0, 0), K(-1, 0), K(-1,  1), K(0, -2), K(-1, -2) } }
+#define SRS_R0 { 5, { K(0, 0), K( 1, 0), K( 1, -1), K(0,  2), K( 1,  2) } }
+#define SRS_R2 { 5, { K(0, 0), K( 1, 0), K( 1, -1), K(0,  2), K( 1,  2) } }
+#define SRS_2R { 5, { K(0, 0), K(-1, 0), K(-1,  1), K(0, -2), K(-1, -2) } }
+#define SRS_2L { 5, { K(0, 0), K( 1, 0), K( 1,  1), K(0, -2), K( 1, -2) } }
+#define SRS_L2 { 5, { K(0, 0), K(-1, 0), K(-1, -1), K(0,  2), K(-1,  2) } }
+#define SRS_L0 { 5, { K(0, 0), K(-1, 0), K(-1, -1), K(0,  2), K(-1,  2) } }
+#define SRS_0L { 5, { K(0, 0), K( 1, 0), K( 1,  1), K(0, -2), K( 1, -2) } }
+
+#define SRS_I_0R { 5, { K(0, 0), K(-2, 0), K( 1, 0), K(-2, -1), K( 1,  2) } }
+#define SRS_I_R0 { 5, { K(0, 0), K( 2, 0), K(-1, 0), K( 2,  1), K(-1, -2) } }
+#define SRS_I_R2 { 5, { K(0, 0), K(-1, 0), K( 2, 0), K(-1,  2), K( 2, -1) } }
+#define SRS_I_2R { 5, { K(0, 0), K( 1, 0), K(-2, 0), K( 1, -2), K(-2,  1) } }
+#define SRS_I_2L { 5, { K(0, 0), K( 2, 0), K(-1, 0), K( 2,  1), K(-1, -2) } }
+#define SRS_I_L2 { 5, { K(0, 0), K(-2, 0), K( 1, 0), K(-2, -1), K( 1,  2) } }
+#define SRS_I_L0 { 5, { K(0, 0), K( 1, 0), K(-2, 0), K( 1, -2), K(-2,  1) } }
+#define SRS_I_0L { 5, { K(0, 0), K(-1, 0), K( 2, 0), K(-1,  2), K( 2, -1) } }
+
+/* Same list for every transition */
+#define EVERY(k) { { k, k }, { k, k }, { k, k }, { k, k } }
+
+/* Rotation index order is 0, L, 2, R; {counter-clockwise, clockwise} */
+#define SRS_JLSTZ { { SRS_0L, SRS_0R }, { SRS_L2, SRS_L0 }, \
+                    { SRS_2R, SRS_2L }, { SRS_R0, SRS_R2 } }
+#define SRS_I     { { SRS_I_0L, SRS_I_0R }, { SRS_I_L2, SRS_I_L0 }, \
+                    { SRS_I_2R, SRS_I_2L }, { SRS_I_R0, SRS_I_R2 } }
+
+static const KickList KICKS[ROTATION_COUNT][PIECE_COUNT][4][2] = {
+    [ROTATION_BASIC] = {
+        EVERY(BASIC_KICKS), EVERY(BASIC_KICKS), EVERY(BASIC_KICKS), EVERY(BASIC_KICKS),
+        EVERY(BASIC_KICKS), EVERY(BASIC_KICKS), EVERY(BASIC_KICKS)
+    },
+    [ROTATION_SRS] = {
+        [PIECE_I] = SRS_I,
+        [PIECE_O] = EVERY(NO_KICK),
+        [PIECE_T] = SRS_JLSTZ,
+        [PIECE_S] = SRS_JLSTZ,
+        [PIECE_Z] = SRS_JLSTZ,
+        [PIECE_J] = SRS_JLSTZ,
+        [PIECE_L] = SRS_JLSTZ,
+    },
+    [ROTATION_ARS] = {
+        [PIECE_I] = EVERY(NO_KICK),
+        [PIECE_O] = EVERY(NO_KICK),
+        [PIECE_T] = EVERY(ARS_KICKS),
+        [PIECE_S] = EVERY(ARS_KICKS),
+        [PIECE_Z] = EVERY(ARS_KICKS),
+        [PIECE_J] = EVERY(ARS_KICKS),
+        [PIECE_L] = EVERY(ARS_KICKS),
+    },
+};
+
+static const char *const SYSTEM_NAMES[ROTATION_COUNT] = { "basic", "srs", "ars" };
 
 void piece_get_cells(const Piece *p, int out[4][2]) {
-    const int (*cells)[4][2] = PIECE_TABLE[p->type];
+    const int (*cells)[4][2] = SHAPES[p->system][p->type];
     int rot = p->rotation & 3;
     for (int i = 0; i < 4; i++) {
         out[i][0] = p->row + cells[rot][i][0];
@@ -90,7 +261,7 @@ void piece_get_cells(const Piece *p, int out[4][2]) {
     }
 }
 
-int piece_valid(const Piece *p) {
+int piece_valid(const Board *b, const Piece *p) {
     int cells[4][2];
     piece_get_cells(p, cells);
     for (int i = 0; i < 4; i++) {
@@ -98,21 +269,26 @@ int piece_valid(const Piece *p) {
         int c = cells[i][1];
         if (!board_in_bounds(r, c))
             return 0;
-        if (!board_is_empty(r, c))
+        if (!board_is_empty(b, r, c))
             return 0;
     }
     return 1;
 }
 
-int piece_try_rotate(Piece *p, int dir) {
+const KickList *piece_kicks(RotationSystem rs, PieceType type, int from, int dir) {
+    return &KICKS[rs][type][from & 3][dir > 0 ? 0 : 1];
+}
+
+int piece_try_rotate(const Board *b, Piece *p, int dir) {
+    const KickList *kl = piece_kicks(p->system, p->type, p->rotation, dir);
     Piece test = *p;
     test.rotation = (test.rotation + dir + 4) & 3;
 
-    for (int k = 0; k < NUM_KICKS; k++) {
+    for (int k = 0; k < kl->count; k++) {
         Piece kicked = test;
-        kicked.row += KICK_OFFSETS[k][0];
-        kicked.col += KICK_OFFSETS[k][1];
-        if (piece_valid(&kicked)) {
+        kicked.row += kl->kicks[k].drow;
+        kicked.col += kl->kicks[k].dcol;
+        if (piece_valid(b, &kicked)) {
             *p = kicked;
             return 1;
         }
@@ -120,24 +296,39 @@ int piece_try_rotate(Piece *p, int dir) {
     return 0;
 }
 
+const char *rotation_system_name(RotationSystem rs) {
+    return SYSTEM_NAMES[rs];
+}
+
+int rotation_system_parse(const char *name, RotationSystem *out) {
+    for (int i = 0; i < ROTATION_COUNT; i++) {
+        if (strcmp(name, SYSTEM_NAMES[i]) == 0) {
+            *out = (RotationSystem)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
 int piece_color(PieceType type) {
     return (int)type + 1;  /* 1-7 */
 }
 
-void piece_spawn(Piece *p, PieceType type) {
+void piece_spawn(Piece *p, PieceType type, RotationSystem rs) {
     p->type = type;
+    p->system = rs;
     p->rotation = 0;
     /* Spawn centered in the hidden buffer area, just above visible region */
     p->row = HIDDEN_HEIGHT - 2;  /* row 18 (one above visible top) */
     p->col = 3;                  /* centered for 4-wide bounding box in 10-wide board */
 }
 
-int piece_ghost_row(const Piece *p) {
+int piece_ghost_row(const Board *b, const Piece *p) {
     Piece ghost = *p;
     while (1) {
         Piece next = ghost;
         next.row++;
-        if (!piece_valid(&next))
+        if (!piece_valid(b, &next))
             break;
         ghost = next;
     }
@@ -1,6 +1,8 @@
 #ifndef PIECE_H
 #define PIECE_H
 
+#include "board.h"
+
 /* Piece types */
 typedef enum {
     PIECE_I = 0,
@@ -13,30 +15,61 @@ typedef enum {
     PIECE_COUNT  /* = 7 */
 } PieceType;
 
+/* One letter per piece type, in PieceType order */
+#define PIECE_LETTERS "IOTSZJL"
+
+/* Rotation systems, selectable per game */
+typedef enum {
+    ROTATION_BASIC = 0,  /* original shapes with six generic kicks */
+    ROTATION_SRS,        /* guideline Super Rotation System */
+    ROTATION_ARS,        /* arcade: bottom-aligned shapes, right/left kicks */
+    ROTATION_COUNT
+} RotationSystem;
+
 /* Active piece state */
 typedef struct {
     PieceType type;
-    int rotation;  /* 0-3 */
+    int rotation;  /* 0-3, each +1 a quarter turn counter-clockwise */
     int row;       /* top-left reference row in board coords */
     int col;       /* top-left reference col in board coords */
+    RotationSystem system;
 } Piece;
 
+#define KICK_MAX 6
+
+typedef struct {
+    signed char drow;
+    signed char dcol;
+} Kick;
+
+typedef struct {
+    int  count;
+    Kick kicks[KICK_MAX];
+} KickList;
+
 /* Get the 4 mino coordinates for a piece. out[4][2] = { {row, col}, ... } */
 void piece_get_cells(const Piece *p, int out[4][2]);
 
-/* Attempt rotation. dir: +1 = CW, -1 = CCW. Returns 1 if successful. */
-int  piece_try_rotate(Piece *p, int dir);
+/* Attempt rotation. dir: +1 = CCW, -1 = CW. Returns 1 if successful. */
+int  piece_try_rotate(const Board *b, Piece *p, int dir);
+
+/* Kick offsets tried in order when rotating type from rotation `from` by dir. */
+const KickList *piece_kicks(RotationSystem rs, PieceType type, int from, int dir);
+
+/* Lowercase system name ("basic", "srs", "ars"), and the reverse lookup (1 if found). */
+const char *rotation_system_name(RotationSystem rs);
+int  rotation_system_parse(const char *name, RotationSystem *out);
 
 /* Check if piece position is valid (in bounds, no collision). */
-int  piece_valid(const Piece *p);
+int  piece_valid(const Board *b, const Piece *p);
 
 /* Get the color ID (1-7) for a piece type. */
 int  piece_color(PieceType type);
 
-/* Spawn coordinates for a given piece type. Sets p->row, p->col, p->rotation. */
-void piece_spawn(Piece *p, PieceType type);
+/* Spawn a piece of the given type and rotation system at the top of the field. */
+void piece_spawn(Piece *p, PieceType type, RotationSystem rs);
 
 /* Get ghost (hard drop) row for a piece. */
-int  piece_ghost_row(const Piece *p);
+int  piece_ghost_row(const Board *b, const Piece *p);
 
 #endif
@@ -2,25 +2,30 @@
 #include "board.h"
 #include "piece.h"
 #include "theme.h"
+#include "layout.h"
 #include <ncurses.h>
 #include <locale.h>
 #include <string.h>
-
-/*
- * Layout (3-column):
- *   Left panel:  score, lines, level
- *   Center:      playfield (10 cells wide × 20 rows, each cell = 2 chars)
- *   Right panel: next piece, status, controls
- */
+#include <stdio.h>
 
 /* Offsets for drawing (row, col in terminal coordinates) */
-#define FIELD_Y      1
-#define LEFT_PANEL_X 2
-#define LEFT_PANEL_W 14
-#define FIELD_X      (LEFT_PANEL_X + LEFT_PANEL_W)  /* board starts after left panel */
-#define PANEL_X      (FIELD_X + BOARD_WIDTH * 2 + 3)  /* right of playfield + border */
+#define FIELD_Y      (origin_y + LAYOUT_FIELD_Y)
+#define LEFT_PANEL_X (origin_x + LAYOUT_LEFT_X)
+#define FIELD_X      (origin_x + LAYOUT_FIELD_X)
+#define PANEL_X      (origin_x + LAYOUT_PANEL_X)
+
+/* Top-left corner of the layout being drawn */
+static int origin_y = 0;
+static int origin_x = 0;
 
+static ScoreEntry high_scores[SCORES_SHOWN];
+static int high_score_count = 0;
+static int high_score_rank = 0;
 
+/* Perfect-clear hint: where the current piece goes, and how many pieces the clear takes */
+static int   hint_enabled = 0;
+static Piece hint_piece;
+static int   hint_length = 0;
 
 void render_init(void) {
     setlocale(LC_ALL, "");
@@ -31,6 +36,7 @@ void render_init(void) {
     keypad(stdscr, TRUE);
     curs_set(0);  /* Hide cursor */
     timeout(0);
+    typeahead(-1);  /* input is read raw by the game thread; never hold output for it */
 
     if (has_colors()) {
         start_color();
@@ -58,89 +64,61 @@ static void draw_cell(int ty, int tx, int color_id, int is_ghost) {
     }
 }
 
-/* Draw the playfield border and contents */
-static void draw_playfield(const Game *g) {
-    int fy = FIELD_Y;
-    int fx = FIELD_X;
-
+/* Draw a box around the w x h area whose top-left cell is (y, x) */
+static void draw_border(int y, int x, int w, int h) {
     attron(COLOR_PAIR(COLOR_BORDER));
 
     /* Top border */
-    mvaddstr(fy - 1, fx - 1, "┌");
-    for (int c = 0; c < BOARD_WIDTH * 2; c++)
+    mvaddstr(y - 1, x - 1, "┌");
+    for (int c = 0; c < w; c++)
         addstr("─");
     addstr("┐");
 
-    /* Side borders and content rows */
-    for (int r = 0; r < VISIBLE_HEIGHT; r++) {
-        int ty = fy + r;
-        mvaddstr(ty, fx - 1, "│");
-        mvaddstr(ty, fx + BOARD_WIDTH * 2, "│");
+    /* Side borders */
+    for (int r = 0; r < h; r++) {
+        mvaddstr(y + r, x - 1, "│");
+        mvaddstr(y + r, x + w, "│");
     }
 
     /* Bottom border */
-    mvaddstr(fy + VISIBLE_HEIGHT, fx - 1, "└");
-    for (int c = 0; c < BOARD_WIDTH * 2; c++)
+    mvaddstr(y + h, x - 1, "└");
+    for (int c = 0; c < w; c++)
         addstr("─");
     addstr("┘");
 
     attroff(COLOR_PAIR(COLOR_BORDER));
+}
 
-    /* Build a display buffer: start with locked board cells */
-    int display[VISIBLE_HEIGHT][BOARD_WIDTH];
-    int ghost_mask[VISIBLE_HEIGHT][BOARD_WIDTH];
-    memset(display, 0, sizeof(display));
-    memset(ghost_mask, 0, sizeof(ghost_mask));
-
-    for (int r = 0; r < VISIBLE_HEIGHT; r++) {
-        int br = HIDDEN_HEIGHT + r;
-        for (int c = 0; c < BOARD_WIDTH; c++) {
-            display[r][c] = board[br][c];
-        }
-    }
+/* Draw the playfield border and contents */
+static void draw_playfield(const Game *g) {
+    int fy = FIELD_Y;
+    int fx = FIELD_X;
 
-    /* Ghost piece */
-    if (g->state == STATE_RUNNING) {
-        int ghost_row = piece_ghost_row(&g->current);
-        Piece ghost = g->current;
-        ghost.row = ghost_row;
-        int ghost_cells[4][2];
-        piece_get_cells(&ghost, ghost_cells);
-        for (int i = 0; i < 4; i++) {
-            int vr = ghost_cells[i][0] - HIDDEN_HEIGHT;
-            int vc = ghost_cells[i][1];
-            if (vr >= 0 && vr < VISIBLE_HEIGHT && vc >= 0 && vc < BOARD_WIDTH) {
-                if (display[vr][vc] == 0) {
-                    ghost_mask[vr][vc] = 1;
-                }
-            }
-        }
+    draw_border(fy, fx, BOARD_WIDTH * 2, VISIBLE_HEIGHT);
 
-        /* Active piece (overwrites ghost if overlapping) */
-        int cells[4][2];
-        piece_get_cells(&g->current, cells);
-        for (int i = 0; i < 4; i++) {
-            int vr = cells[i][0] - HIDDEN_HEIGHT;
-            int vc = cells[i][1];
-            if (vr >= 0 && vr < VISIBLE_HEIGHT && vc >= 0 && vc < BOARD_WIDTH) {
-                display[vr][vc] = piece_color(g->current.type);
-                ghost_mask[vr][vc] = 0;
-            }
-        }
-    }
+    LayoutCell cells[VISIBLE_HEIGHT][BOARD_WIDTH];
+    layout_playfield(g, hint_enabled && hint_length > 0 ? &hint_piece : NULL, cells);
 
-    /* Render cells */
-    int flash_invert = g->flash_active && (g->flash_count % 2 == 1);
     for (int r = 0; r < VISIBLE_HEIGHT; r++) {
         for (int c = 0; c < BOARD_WIDTH; c++) {
             int ty = fy + r;
             int tx = fx + c * 2;
-            if (flash_invert && display[r][c] > 0) {
-                attron(COLOR_PAIR(display[r][c]) | A_REVERSE | A_BOLD);
-                mvaddstr(ty, tx, "██");
-                attroff(COLOR_PAIR(display[r][c]) | A_REVERSE | A_BOLD);
-            } else {
-                draw_cell(ty, tx, display[r][c], ghost_mask[r][c]);
+            const LayoutCell *cell = &cells[r][c];
+            switch (cell->kind) {
+                case LAYOUT_FLASH:
+                    attron(COLOR_PAIR(cell->color) | A_REVERSE | A_BOLD);
+                    mvaddstr(ty, tx, "██");
+                    attroff(COLOR_PAIR(cell->color) | A_REVERSE | A_BOLD);
+                    break;
+                case LAYOUT_HINT:
+                    attron(COLOR_PAIR(cell->color));
+                    mvaddstr(ty, tx, "▒▒");
+                    attroff(COLOR_PAIR(cell->color));
+                    break;
+                default:
+                    draw_cell(ty, tx, cell->kind == LAYOUT_BLOCK ? cell->color : 0,
+                              cell->kind == LAYOUT_GHOST);
+                    break;
             }
         }
     }
@@ -162,7 +140,7 @@ static void draw_next_piece(const Game *g) {
 
     /* Draw next piece in preview */
     Piece preview;
-    piece_spawn(&preview, g->next);
+    piece_spawn(&preview, g->next, g->rotation);
     preview.row = 0;
     preview.col = 0;
 
@@ -208,6 +186,41 @@ static void draw_stats(const Game *g) {
     attroff(COLOR_PAIR(COLOR_LEGEND) | A_DIM);
 }
 
+/* Draw the leaderboard under the stats (game over only) */
+static void draw_high_scores(const Game *g) {
+    if (g->state != STATE_GAMEOVER || high_score_count == 0)
+        return;
+
+    int px = LEFT_PANEL_X;
+    int py = FIELD_Y + 11;
+
+    attron(COLOR_PAIR(COLOR_LABEL) | A_BOLD);
+    mvprintw(py, px, "HIGH SCORES:");
+    attroff(COLOR_PAIR(COLOR_LABEL) | A_BOLD);
+
+    for (int i = 0; i < high_score_count; i++) {
+        int attr = COLOR_PAIR(COLOR_LABEL) | (i + 1 == high_score_rank ? A_REVERSE : 0);
+        attron(attr);
+        mvprintw(py + 1 + i, px, "%2d %9u", i + 1, high_scores[i].score);
+        attroff(attr);
+    }
+}
+
+void render_set_scores(const ScoreEntry *top, int count, int rank) {
+    if (count > SCORES_SHOWN)
+        count = SCORES_SHOWN;
+    memcpy(high_scores, top, (size_t)count * sizeof(*top));
+    high_score_count = count;
+    high_score_rank = rank;
+}
+
+void render_set_hint(int enabled, const Piece *path, int count) {
+    hint_enabled = enabled;
+    hint_length = count;
+    if (count > 0)
+        hint_piece = path[0];
+}
+
 /* Draw status line */
 static void draw_status(const Game *g) {
     int px = PANEL_X;
@@ -231,6 +244,14 @@ static void draw_status(const Game *g) {
             mvprintw(py + 1, px, "Q to quit");
             break;
         default:
+            if (hint_enabled) {
+                attron(COLOR_PAIR(COLOR_LABEL));
+                if (hint_length > 0)
+                    mvprintw(py, px, "PC in %d", hint_length);
+                else
+                    mvprintw(py, px, "PC: none");
+                attroff(COLOR_PAIR(COLOR_LABEL));
+            }
             break;
     }
 }
@@ -245,7 +266,7 @@ static void draw_help(void) {
     mvprintw(py + 1, px, "Z:CCW X:CW");
     mvprintw(py + 2, px, "Up/Space:Drop");
     mvprintw(py + 3, px, "P:Pause Q:Quit");
-    mvprintw(py + 4, px, "T:Theme");
+    mvprintw(py + 4, px, "T:Theme H:Hint");
     attroff(COLOR_PAIR(COLOR_LEGEND) | A_DIM);
 }
 
@@ -254,7 +275,181 @@ void render_draw(const Game *g) {
     draw_playfield(g);
     draw_next_piece(g);
     draw_stats(g);
+    draw_high_scores(g);
     draw_status(g);
     draw_help();
     refresh();
 }
+
+void render_draw_versus(const Game *left, const Game *right) {
+    erase();
+    for (int side = 0; side < 2; side++) {
+        const Game *g = side == 0 ? left : right;
+        origin_x = side * LAYOUT_WIDTH;
+        draw_playfield(g);
+        draw_next_piece(g);
+        draw_stats(g);
+        draw_status(g);
+    }
+    origin_x = 0;
+    draw_help();
+    refresh();
+}
+
+/* ── Tiled viewer ────────────────────────────────────────────────── */
+
+/* Half-block mini playfield: each terminal cell shows two board rows */
+#define MINI_H          (VISIBLE_HEIGHT / 2)
+#define MINI_FIELD_Y    (origin_y + 1)
+#define MINI_FIELD_X    (origin_x + 1)
+#define TILE_W          (BOARD_WIDTH + 3)  /* borders and a gap */
+#define TILE_H          (MINI_H + 3)       /* borders and the score line */
+#define TILE_CELL_BYTES 5                  /* estimated output per cell: glyph and color */
+#define TILE_MOVE_BYTES 8                  /* ... and per cursor jump to a run of cells */
+
+/* Pairs for cells whose halves differ in color: fg = top, bg = bottom */
+#define MIXED_PAIR_BASE 16
+#define MIXED_COLORS    8    /* piece colors and garbage */
+
+static int  mixed_pairs = -1;  /* -1 = not set up, 0 = too few pairs on this terminal */
+static char tile_status[256];
+static int  tile_cols = -1, tile_lines = -1;  /* terminal size the grid was laid out for */
+
+static void init_mixed_pairs(void) {
+    mixed_pairs = has_colors() && COLOR_PAIRS > MIXED_PAIR_BASE + MIXED_COLORS * MIXED_COLORS;
+    if (!mixed_pairs)
+        return;
+    for (int top = 1; top <= MIXED_COLORS; top++) {
+        for (int bottom = 1; bottom <= MIXED_COLORS; bottom++) {
+            short fg_top, fg_bottom, bg;
+            pair_content((short)top, &fg_top, &bg);
+            pair_content((short)bottom, &fg_bottom, &bg);
+            init_pair((short)(MIXED_PAIR_BASE + (top - 1) * MIXED_COLORS + bottom - 1),
+                      fg_top, fg_bottom);
+        }
+    }
+}
+
+/* Draw two vertically stacked board cells in one terminal cell */
+static void draw_half_blocks(int ty, int tx, int top, int bottom) {
+    const char *glyph;
+    int pair;
+
+    if (top > MIXED_COLORS)
+        top = MIXED_COLORS;
+    if (bottom > MIXED_COLORS)
+        bottom = MIXED_COLORS;
+
+    if (!top && !bottom) {
+        mvaddstr(ty, tx, " ");
+        return;
+    }
+    if (top == bottom || (top && bottom && !mixed_pairs)) {
+        glyph = "█";
+        pair = top;
+    } else if (!bottom) {
+        glyph = "▀";
+        pair = top;
+    } else if (!top) {
+        glyph = "▄";
+        pair = bottom;
+    } else {
+        glyph = "▀";
+        pair = MIXED_PAIR_BASE + (top - 1) * MIXED_COLORS + bottom - 1;
+    }
+    attron(COLOR_PAIR(pair));
+    mvaddstr(ty, tx, glyph);
+    attroff(COLOR_PAIR(pair));
+}
+
+/* Estimated terminal output for runs of cells */
+static size_t run_bytes(int runs, int cells) {
+    return (size_t)runs * TILE_MOVE_BYTES + (size_t)cells * TILE_CELL_BYTES;
+}
+
+/* Draw one tile at the current origin. Returns its estimated output in bytes. */
+static size_t draw_tile(const RenderTile *t, const RenderTile *prev) {
+    size_t bytes = 0;
+
+    if (!prev) {
+        draw_border(MINI_FIELD_Y, MINI_FIELD_X, BOARD_WIDTH, MINI_H);
+        attron(COLOR_PAIR(COLOR_LABEL) | A_BOLD);
+        mvprintw(MINI_FIELD_Y - 1, MINI_FIELD_X, "%.*s", BOARD_WIDTH, t->name);
+        attroff(COLOR_PAIR(COLOR_LABEL) | A_BOLD);
+        bytes += run_bytes(2 + 2 * MINI_H, 2 * (BOARD_WIDTH + 2) + 2 * MINI_H);
+    }
+
+    for (int r = 0; r < MINI_H; r++) {
+        const unsigned char *top = t->cells[2 * r], *bottom = t->cells[2 * r + 1];
+        int runs = 0, cells = 0, last = -2;
+        for (int c = 0; c < BOARD_WIDTH; c++) {
+            if (prev && prev->cells[2 * r][c] == top[c] && prev->cells[2 * r + 1][c] == bottom[c])
+                continue;
+            draw_half_blocks(MINI_FIELD_Y + r, MINI_FIELD_X + c, top[c], bottom[c]);
+            runs += c != last + 1;
+            cells++;
+            last = c;
+        }
+        bytes += run_bytes(runs, cells);
+    }
+
+    /* Score and lines; reversed once the game is over */
+    if (!prev || prev->score != t->score || prev->lines != t->lines || prev->state != t->state) {
+        int attr = COLOR_PAIR(COLOR_LABEL) | (t->state == STATE_GAMEOVER ? A_REVERSE : 0);
+        attron(attr);
+        mvprintw(MINI_FIELD_Y + MINI_H + 1, origin_x, "%7d %4d", t->score, t->lines);
+        attroff(attr);
+        bytes += run_bytes(1, TILE_W - 1);
+    }
+    return bytes;
+}
+
+int render_tiles_capacity(void) {
+    int capacity = (COLS / TILE_W) * ((LINES - 1) / TILE_H);
+    return capacity < RENDER_TILES_MAX ? capacity : RENDER_TILES_MAX;
+}
+
+size_t render_draw_tiles(const RenderTile *tiles, const RenderTile *prev, int count,
+                         const char *status) {
+    if (mixed_pairs < 0)
+        init_mixed_pairs();
+
+    /* A resize moves every tile: what was drawn before is no guide */
+    if (COLS != tile_cols || LINES != tile_lines) {
+        tile_cols = COLS;
+        tile_lines = LINES;
+        prev = NULL;
+    }
+
+    int per_row = COLS / TILE_W > 0 ? COLS / TILE_W : 1;
+    int capacity = render_tiles_capacity();
+    size_t bytes = 0;
+
+    if (!prev) {
+        erase();
+        tile_status[0] = '\0';
+    }
+    for (int i = 0; i < count && i < capacity; i++) {
+        if (prev && memcmp(&tiles[i], &prev[i], sizeof(*tiles)) == 0)
+            continue;
+        origin_y = i / per_row * TILE_H;
+        origin_x = i % per_row * TILE_W;
+        bytes += draw_tile(&tiles[i], prev ? &prev[i] : NULL);
+    }
+    origin_y = 0;
+    origin_x = 0;
+
+    if (strcmp(status, tile_status) != 0) {
+        snprintf(tile_status, sizeof(tile_status), "%s", status);
+        move(LINES - 1, 0);
+        clrtoeol();
+        attron(COLOR_PAIR(COLOR_LEGEND) | A_DIM);
+        mvaddnstr(LINES - 1, 0, tile_status, COLS - 1);
+        attroff(COLOR_PAIR(COLOR_LEGEND) | A_DIM);
+        bytes += run_bytes(1, (int)strlen(tile_status));
+    }
+
+    if (bytes > 0)
+        refresh();
+    return bytes;
+}
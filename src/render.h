@@ -2,9 +2,53 @@
 #define RENDER_H
 
 #include "game.h"
+#include "scores.h"
+#include <stddef.h>
 
 void render_init(void);
 void render_cleanup(void);
 void render_draw(const Game *g);
 
+/* Versus mode: the local player's game on the left, the opponent's on the right. */
+void render_draw_versus(const Game *left, const Game *right);
+
+/* Most games the tiled viewer shows at once */
+#define RENDER_TILES_MAX 64
+
+/* One game as a viewer tile shows it. Build with memset first: tiles are compared bytewise. */
+typedef struct {
+    unsigned char cells[VISIBLE_HEIGHT][BOARD_WIDTH];  /* color id, 0 = empty */
+    int  score;
+    int  lines;
+    int  state;     /* GameState */
+    char name[16];  /* shown in the top border */
+} RenderTile;
+
+/* Tiles that fit on the terminal at once. */
+int    render_tiles_capacity(void);
+
+/*
+ * Draw count tiles in a grid of half-block mini playfields, with a status
+ * line at the bottom. Tiles equal to prev[i] (what was drawn last) are
+ * skipped, and only the changed cells of the others are drawn; prev =
+ * NULL clears the screen and draws everything, as does the first call
+ * after the terminal is resized. Returns an estimate of the bytes sent
+ * to the terminal.
+ */
+size_t render_draw_tiles(const RenderTile *tiles, const RenderTile *prev, int count,
+                         const char *status);
+
+/* High scores shown under the stats on the game-over screen */
+#define SCORES_SHOWN 8
+
+/* Leaderboard shown on the game-over screen; rank (1-based) is highlighted, 0 for none. */
+void render_set_scores(const ScoreEntry *top, int count, int rank);
+
+/*
+ * Perfect-clear hint: path is the placement sequence from pc_find_game()
+ * (count 0 = none found). path[0] is outlined on the board. enabled = 0
+ * hides the hint.
+ */
+void render_set_hint(int enabled, const Piece *path, int count);
+
 #endif
@@ -0,0 +1,125 @@
+#include "replay.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_HEADER 12
+
+static void put_varint(FILE *f, uint32_t v) {
+    unsigned char buf[5];
+    int n = 0;
+    while (v >= 0x80) {
+        buf[n++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = (unsigned char)v;
+    fwrite(buf, 1, (size_t)n, f);
+}
+
+/* ── Writing ─────────────────────────────────────────────────────── */
+
+int replay_create(ReplayWriter *w, const char *path, uint32_t seed, RotationSystem rs) {
+    unsigned char header[REPLAY_HEADER] = { 'T', 'V', 'R', 'P', REPLAY_VERSION, (unsigned char)rs, 0, 0,
+                                            (unsigned char)seed, (unsigned char)(seed >> 8),
+                                            (unsigned char)(seed >> 16), (unsigned char)(seed >> 24) };
+    w->f = fopen(path, "wb");
+    if (!w->f)
+        return 0;
+    fwrite(header, 1, sizeof(header), w->f);
+    return 1;
+}
+
+void replay_action(ReplayWriter *w, InputAction action) {
+    put_varint(w->f, (uint32_t)action);
+}
+
+void replay_step(ReplayWriter *w, unsigned dt_ms) {
+    if (dt_ms > 0)
+        put_varint(w->f, (uint32_t)dt_ms << 4 | ACTION_NONE);
+}
+
+int replay_close(ReplayWriter *w) {
+    int ok = !ferror(w->f);
+    ok &= fclose(w->f) == 0;
+    w->f = NULL;
+    return ok;
+}
+
+/* ── Reading ─────────────────────────────────────────────────────── */
+
+int replay_open(ReplayReader *r, const char *path) {
+    memset(r, 0, sizeof(*r));
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return 0;
+
+    size_t cap = 4096;
+    r->data = malloc(cap);
+    while (r->data) {
+        r->len += fread(r->data + r->len, 1, cap - r->len, f);
+        if (r->len < cap)
+            break;
+        unsigned char *grown = realloc(r->data, cap * 2);
+        if (!grown) {
+            free(r->data);
+            r->data = NULL;
+            break;
+        }
+        r->data = grown;
+        cap *= 2;
+    }
+    fclose(f);
+
+    if (!r->data || r->len < REPLAY_HEADER || memcmp(r->data, "TVRP", 4) != 0
+        || r->data[4] != REPLAY_VERSION || r->data[5] >= ROTATION_COUNT) {
+        replay_free(r);
+        return 0;
+    }
+    r->rotation = (RotationSystem)r->data[5];
+    r->seed = (uint32_t)r->data[8] | (uint32_t)r->data[9] << 8
+            | (uint32_t)r->data[10] << 16 | (uint32_t)r->data[11] << 24;
+    r->pos = REPLAY_HEADER;
+    return 1;
+}
+
+void replay_free(ReplayReader *r) {
+    free(r->data);
+    r->data = NULL;
+    r->len = r->pos = 0;
+}
+
+int replay_next(ReplayReader *r, InputAction *action, unsigned *dt_ms) {
+    uint32_t v = 0;
+    for (int shift = 0; ; shift += 7) {
+        if (r->pos >= r->len || shift > 28)
+            return 0;  /* end, or a record cut short */
+        unsigned char b = r->data[r->pos++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            break;
+    }
+    *action = (InputAction)(v & 15);
+    *dt_ms = v >> 4;
+    return 1;
+}
+
+/* ── Playback ────────────────────────────────────────────────────── */
+
+void replay_start(const ReplayReader *r, Game *g) {
+    game_init(g, r->seed);
+    game_set_rotation(g, r->rotation);
+}
+
+unsigned replay_advance(ReplayReader *r, Game *g) {
+    InputAction action;
+    unsigned dt;
+    while (g->state != STATE_QUIT && replay_next(r, &action, &dt)) {
+        if (action == ACTION_NONE) {
+            game_update(g, dt);
+            return dt;
+        }
+        if (action == ACTION_THEME)
+            r->theme_cycles++;
+        input_handle(g, action);
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "input.h"
+#include "game.h"
+
+/*
+ * Game recordings (`termv --record PATH`): the seed and rotation system,
+ * then every input and every update step in the order the game loop ran
+ * them, so feeding them back through input_handle and game_update
+ * reproduces the game exactly.
+ *
+ * Layout, little-endian:
+ *   "TVRP" magic, u8 version, u8 rotation system, u16 reserved, u32 seed
+ *   varint records: low 4 bits an InputAction; ACTION_NONE means "advance
+ *   the game", by the milliseconds in the upper bits
+ *
+ * A frame with no input costs one or two bytes.
+ */
+
+#define REPLAY_VERSION 1
+
+typedef struct {
+    FILE *f;
+} ReplayWriter;
+
+typedef struct {
+    unsigned char *data;
+    size_t         len;
+    size_t         pos;
+    uint32_t       seed;
+    RotationSystem rotation;
+    unsigned       theme_cycles;  /* theme changes played back so far */
+} ReplayReader;
+
+/* Start a recording. Returns 0 if path can't be written. */
+int  replay_create(ReplayWriter *w, const char *path, uint32_t seed, RotationSystem rs);
+void replay_action(ReplayWriter *w, InputAction action);
+void replay_step(ReplayWriter *w, unsigned dt_ms);
+/* Returns 0 if any write failed. */
+int  replay_close(ReplayWriter *w);
+
+/* Load a recording. Returns 0 if it is missing or not a replay. */
+int  replay_open(ReplayReader *r, const char *path);
+void replay_free(ReplayReader *r);
+
+/*
+ * Next record: an action (*dt_ms = 0), or ACTION_NONE with the step
+ * length in *dt_ms. Returns 0 at the end of the recording.
+ */
+int  replay_next(ReplayReader *r, InputAction *action, unsigned *dt_ms);
+
+/* Start g as the recorded game started. */
+void replay_start(const ReplayReader *r, Game *g);
+
+/*
+ * Apply records to g up to and including the next update step. Returns
+ * the step length in ms, 0 once the recording (or the game) has ended.
+ */
+unsigned replay_advance(ReplayReader *r, Game *g);
+
+#endif
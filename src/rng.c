@@ -0,0 +1,17 @@
+#include "rng.h"
+
+void rng_advance(Rng *r, uint64_t delta) {
+    /* Brown, "Random Number Generation with Arbitrary Strides" */
+    uint64_t cur_mult = PCG_MULT, cur_plus = r->inc;
+    uint64_t acc_mult = 1, acc_plus = 0;
+    while (delta > 0) {
+        if (delta & 1) {
+            acc_mult *= cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+        cur_plus = (cur_mult + 1) * cur_plus;
+        cur_mult *= cur_mult;
+        delta >>= 1;
+    }
+    r->state = acc_mult * r->state + acc_plus;
+}
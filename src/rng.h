@@ -0,0 +1,51 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/*
+ * PCG32 (O'Neill, pcg-random.org): 64-bit LCG state with a permuted 32-bit
+ * output. Pure integer arithmetic, so a seed gives the same sequence on
+ * every platform and libc. rng_advance() jumps ahead in O(log n).
+ *
+ * Seeding and stepping are inline: the bag shuffle and seed search run
+ * them billions of times, and a call per draw costs as much as the draw.
+ */
+typedef struct {
+    uint64_t state;
+    uint64_t inc;  /* stream selector, always odd */
+} Rng;
+
+#define PCG_MULT   6364136223846793005ULL
+#define PCG_STREAM 0xda3e39cb94b95bdbULL
+
+static inline uint32_t rng_next(Rng *r) {
+    uint64_t old = r->state;
+    r->state = old * PCG_MULT + r->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+static inline void rng_seed(Rng *r, uint32_t seed) {
+    /* SplitMix64 finalizer: spreads nearby seeds across the state space */
+    uint64_t x = seed + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+    r->state = 0;
+    r->inc = (PCG_STREAM << 1) | 1;
+    rng_next(r);
+    r->state += x ^ (x >> 31);
+    rng_next(r);
+}
+
+/* Uniform value in [0, n) from exactly one draw (bias < n / 2^32). */
+static inline uint32_t rng_below(Rng *r, uint32_t n) {
+    return (uint32_t)(((uint64_t)rng_next(r) * n) >> 32);
+}
+
+/* Skip delta outputs, as if rng_next() had been called delta times. */
+void rng_advance(Rng *r, uint64_t delta);
+
+#endif
@@ -0,0 +1,526 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "scores.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define LOG_NAME         "scores.log"
+#define IDX_NAME         "scores.idx"
+#define LOCK_NAME        "scores.lock"
+#define LOG_MAGIC        0x314C5354u  /* "TSL1" */
+#define IDX_MAGIC        0x31495354u  /* "TSI1" */
+#define IDX_VERSION      2
+#define IDX_MIN_BUCKETS  8192         /* powers of two */
+#define IDX_MAX_BUCKETS  (1u << 20)
+#define IDX_MAX_PROBE    64
+
+/* One log record. Written with a single write() on an O_APPEND descriptor. */
+typedef struct {
+    uint32_t   magic;
+    uint32_t   check;  /* FNV-1a of mode, seed and entry */
+    uint32_t   mode;
+    uint32_t   seed;
+    ScoreEntry entry;
+} LogRecord;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t top_k;
+    uint32_t buckets;
+    uint64_t log_end;   /* log bytes indexed when the file was built */
+    uint32_t retired;   /* set once a rebuilt index has replaced this file */
+    uint8_t  pad[36];
+} IndexHeader;
+
+enum { BUCKET_EMPTY, BUCKET_CLAIMING, BUCKET_READY };
+
+/* One top-K list. seq is odd while a writer is changing entries. */
+typedef struct {
+    uint32_t   state;
+    uint32_t   seq;
+    uint32_t   mode;
+    uint32_t   seed;
+    uint32_t   any_seed;
+    uint32_t   count;
+    uint32_t   pad[2];
+    ScoreEntry entries[SCORES_TOP_K];
+} IndexBucket;
+
+struct ScoreStore {
+    int          log_fd;   /* O_APPEND, for writing */
+    int          lock_fd;  /* held while an index is rebuilt */
+    char         log_path[512];
+    char         idx_path[512];
+    int          idx_fd;
+    IndexHeader *idx;
+    IndexBucket *buckets;
+    uint32_t     bucket_count;
+};
+
+static size_t index_size(uint32_t buckets) {
+    return sizeof(IndexHeader) + (size_t)buckets * sizeof(IndexBucket);
+}
+
+/* ── Helpers ─────────────────────────────────────────────────────── */
+
+static uint32_t record_check(const LogRecord *r) {
+    const unsigned char *p = (const unsigned char *)&r->mode;
+    size_t n = sizeof(*r) - offsetof(LogRecord, mode);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+static uint32_t key_hash(uint32_t mode, uint32_t seed, uint32_t any_seed) {
+    uint64_t x = ((uint64_t)mode << 33) ^ ((uint64_t)any_seed << 32) ^ seed;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return (uint32_t)x;
+}
+
+/* Blocking fcntl byte-range lock; type is F_RDLCK, F_WRLCK or F_UNLCK. */
+static void range_lock(int fd, short type, off_t start, off_t len) {
+    struct flock fl;
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = start;
+    fl.l_len = len;
+    while (fcntl(fd, type == F_UNLCK ? F_SETLK : F_SETLKW, &fl) < 0 && errno == EINTR)
+        ;
+}
+
+int scores_make_dir(const char *dir) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s", dir);
+    for (char *p = path + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            if (mkdir(path, 0755) != 0 && errno != EEXIST)
+                return 0;
+            *p = '/';
+        }
+    }
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+/* ── Index buckets ───────────────────────────────────────────────── */
+
+static off_t bucket_offset(ScoreStore *s, const IndexBucket *b) {
+    return (off_t)((const char *)b - (const char *)s->idx);
+}
+
+/*
+ * Buckets are claimed under their lock, which the kernel drops if the
+ * claimer dies. A writer holding the lock on a bucket that is not READY
+ * has found it empty or abandoned mid-claim, and takes it. Readers skip a
+ * bucket being claimed.
+ */
+static IndexBucket *find_bucket(ScoreStore *s, uint32_t mode, uint32_t seed,
+                                uint32_t any_seed, int create) {
+    if (any_seed)
+        seed = 0;
+    uint32_t h = key_hash(mode, seed, any_seed);
+
+    for (int i = 0; i < IDX_MAX_PROBE; i++) {
+        IndexBucket *b = &s->buckets[(h + (uint32_t)i) & (s->bucket_count - 1)];
+        uint32_t state = __atomic_load_n(&b->state, __ATOMIC_ACQUIRE);
+
+        if (state == BUCKET_EMPTY && !create)
+            return NULL;
+        if (state != BUCKET_READY && create) {
+            off_t off = bucket_offset(s, b);
+            range_lock(s->idx_fd, F_WRLCK, off, (off_t)sizeof(*b));
+            state = __atomic_load_n(&b->state, __ATOMIC_ACQUIRE);
+            if (state != BUCKET_READY) {
+                __atomic_store_n(&b->state, BUCKET_CLAIMING, __ATOMIC_RELAXED);
+                b->mode = mode;
+                b->seed = seed;
+                b->any_seed = any_seed;
+                b->count = 0;
+                __atomic_store_n(&b->state, BUCKET_READY, __ATOMIC_RELEASE);
+            }
+            range_lock(s->idx_fd, F_UNLCK, off, (off_t)sizeof(*b));
+            if (state != BUCKET_READY)
+                return b;
+        }
+
+        if (state == BUCKET_READY && b->mode == mode && b->seed == seed
+            && b->any_seed == any_seed)
+            return b;
+    }
+    return NULL;  /* Probe run full: the index needs to grow */
+}
+
+/* Insert into a bucket's sorted list. Caller holds the bucket lock. Returns rank or 0. */
+static int bucket_insert(IndexBucket *b, const ScoreEntry *e) {
+    uint32_t n = b->count;
+    uint32_t pos = 0;
+    while (pos < n && b->entries[pos].score >= e->score)
+        pos++;
+    if (pos >= SCORES_TOP_K)
+        return 0;
+
+    uint32_t keep = n < SCORES_TOP_K ? n : SCORES_TOP_K - 1;
+    memmove(&b->entries[pos + 1], &b->entries[pos],
+            (keep - pos) * sizeof(b->entries[0]));
+    b->entries[pos] = *e;
+    b->count = keep + 1;
+    return (int)pos + 1;
+}
+
+static int record_matches(const LogRecord *r, const IndexBucket *b) {
+    return r->mode == b->mode && (b->any_seed || r->seed == b->seed);
+}
+
+/*
+ * Walk every intact record in the log. A torn record (crash mid-append)
+ * fails its checksum; the scan then slides forward a byte at a time until
+ * it finds the next valid record. Returns the log size scanned.
+ */
+static size_t scan_log(ScoreStore *s, void (*fn)(ScoreStore *, const LogRecord *, void *),
+                       void *ctx) {
+    int fd = open(s->log_path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        st.st_size = 0;
+    if (st.st_size < (off_t)sizeof(LogRecord)) {
+        close(fd);
+        return (size_t)st.st_size;
+    }
+    size_t size = (size_t)st.st_size;
+    const unsigned char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return 0;
+
+    size_t off = 0;
+    while (off + sizeof(LogRecord) <= size) {
+        LogRecord r;
+        memcpy(&r, data + off, sizeof(r));
+        if (r.magic == LOG_MAGIC && r.check == record_check(&r)) {
+            fn(s, &r, ctx);
+            off += sizeof(r);
+        } else {
+            off++;
+        }
+    }
+    munmap((void *)data, size);
+    return size;
+}
+
+static void refill_one(ScoreStore *s, const LogRecord *r, void *ctx) {
+    (void)s;
+    IndexBucket *b = ctx;
+    if (record_matches(r, b))
+        bucket_insert(b, &r->entry);
+}
+
+/* A writer died mid-update: rebuild this list from the log. */
+static void bucket_repair(ScoreStore *s, IndexBucket *b) {
+    b->count = 0;
+    scan_log(s, refill_one, b);
+}
+
+static void index_one(ScoreStore *s, const LogRecord *r, void *ctx) {
+    int *overflow = ctx;
+    IndexBucket *b = find_bucket(s, r->mode, r->seed, 0, 1);
+    if (b)
+        bucket_insert(b, &r->entry);
+    else
+        *overflow = 1;
+    b = find_bucket(s, r->mode, 0, 1, 1);
+    if (b)
+        bucket_insert(b, &r->entry);
+    else
+        *overflow = 1;
+}
+
+static int index_valid(const IndexHeader *h) {
+    return h->magic == IDX_MAGIC && h->version == IDX_VERSION
+        && h->top_k == SCORES_TOP_K && h->buckets >= IDX_MIN_BUCKETS
+        && h->buckets <= IDX_MAX_BUCKETS && (h->buckets & (h->buckets - 1)) == 0;
+}
+
+/* Map the index file. Returns 0 if it is missing or not a valid index. */
+static int index_map(ScoreStore *s) {
+    int fd = open(s->idx_path, O_RDWR);
+    if (fd < 0)
+        return 0;
+    IndexHeader h;
+    struct stat st;
+    if (pread(fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h) || !index_valid(&h)
+        || fstat(fd, &st) != 0 || st.st_size != (off_t)index_size(h.buckets)) {
+        close(fd);
+        return 0;
+    }
+    void *map = mmap(NULL, index_size(h.buckets), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return 0;
+    }
+    s->idx_fd = fd;
+    s->idx = map;
+    s->buckets = (IndexBucket *)(s->idx + 1);
+    s->bucket_count = h.buckets;
+    return 1;
+}
+
+static void index_unmap(ScoreStore *s) {
+    if (s->idx)
+        munmap(s->idx, index_size(s->bucket_count));
+    if (s->idx_fd >= 0)
+        close(s->idx_fd);
+    s->idx = NULL;
+    s->buckets = NULL;
+    s->idx_fd = -1;
+}
+
+/*
+ * Index the whole log into a new file, doubling the table until every list
+ * fits, then rename it over the live index. Nobody maps the new file until
+ * it is complete.
+ */
+static int index_build(const ScoreStore *s, uint32_t buckets) {
+    char tmp_path[520];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", s->idx_path);
+
+    for (;;) {
+        ScoreStore b = *s;
+        b.idx_fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (b.idx_fd < 0)
+            return 0;
+        b.bucket_count = buckets;
+        void *map = MAP_FAILED;
+        if (ftruncate(b.idx_fd, (off_t)index_size(buckets)) == 0)
+            map = mmap(NULL, index_size(buckets), PROT_READ | PROT_WRITE, MAP_SHARED,
+                       b.idx_fd, 0);
+        if (map == MAP_FAILED) {
+            close(b.idx_fd);
+            unlink(tmp_path);
+            return 0;
+        }
+        b.idx = map;
+        b.buckets = (IndexBucket *)(b.idx + 1);
+
+        int overflow = 0;
+        b.idx->log_end = scan_log(&b, index_one, &overflow);
+        if (overflow && buckets < IDX_MAX_BUCKETS) {
+            index_unmap(&b);
+            buckets *= 2;
+            continue;
+        }
+        b.idx->top_k = SCORES_TOP_K;
+        b.idx->buckets = buckets;
+        b.idx->version = IDX_VERSION;
+        b.idx->magic = IDX_MAGIC;
+        int ok = rename(tmp_path, s->idx_path) == 0;
+        index_unmap(&b);
+        if (!ok)
+            unlink(tmp_path);
+        return ok;
+    }
+}
+
+/*
+ * Replace the live index with one of at least buckets buckets, unless
+ * another process already has. The old file is retired under its header
+ * write lock, so no writer is inside it; its users then map the new one.
+ */
+static int index_replace(ScoreStore *s, uint32_t buckets) {
+    range_lock(s->lock_fd, F_WRLCK, 0, 0);
+
+    ScoreStore cur = *s;
+    int have = index_map(&cur);
+    int ok = 1;
+    if (!have || cur.bucket_count < buckets) {
+        if (have)
+            range_lock(cur.idx_fd, F_WRLCK, 0, (off_t)sizeof(IndexHeader));
+        ok = index_build(s, buckets);
+        if (ok && have)
+            __atomic_store_n(&cur.idx->retired, 1, __ATOMIC_RELEASE);
+        if (have)
+            range_lock(cur.idx_fd, F_UNLCK, 0, (off_t)sizeof(IndexHeader));
+    }
+    if (have)
+        index_unmap(&cur);
+
+    range_lock(s->lock_fd, F_UNLCK, 0, 0);
+    return ok;
+}
+
+/* Point s at the live index, building one if it is missing or damaged. */
+static int index_attach(ScoreStore *s) {
+    for (int attempt = 0; attempt < 8; attempt++) {
+        if (s->idx && !__atomic_load_n(&s->idx->retired, __ATOMIC_ACQUIRE))
+            return 1;
+        index_unmap(s);
+        if (!index_map(s) && !index_replace(s, IDX_MIN_BUCKETS))
+            return 0;
+    }
+    return 0;
+}
+
+/*
+ * Lock one bucket and add e, or find it if the list already holds it: the
+ * index was built after e reached the log, or a previous writer crashed
+ * mid-update and the list is rebuilt from the log. Returns e's rank or 0.
+ */
+static int locked_insert(ScoreStore *s, IndexBucket *b, const ScoreEntry *e, int indexed) {
+    off_t off = bucket_offset(s, b);
+    range_lock(s->idx_fd, F_WRLCK, off, (off_t)sizeof(*b));
+
+    uint32_t seq = b->seq;
+    __atomic_store_n(&b->seq, seq + 1 + (seq & 1), __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    int rank = 0;
+    if (seq & 1) {
+        bucket_repair(s, b);
+        indexed = 1;
+    }
+    if (indexed) {
+        for (uint32_t i = 0; i < b->count && !rank; i++) {
+            if (memcmp(&b->entries[i], e, sizeof(*e)) == 0)
+                rank = (int)i + 1;
+        }
+    } else {
+        rank = bucket_insert(b, e);
+    }
+    __atomic_store_n(&b->seq, seq + 2 + (seq & 1), __ATOMIC_RELEASE);
+
+    range_lock(s->idx_fd, F_UNLCK, off, (off_t)sizeof(*b));
+    return rank;
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+int scores_default_dir(char *buf, int size) {
+    const char *env = getenv("TERMV_HOME");
+    if (env && *env)
+        return snprintf(buf, (size_t)size, "%s", env) < size;
+    env = getenv("XDG_DATA_HOME");
+    if (env && *env)
+        return snprintf(buf, (size_t)size, "%s/termv", env) < size;
+    env = getenv("HOME");
+    if (env && *env)
+        return snprintf(buf, (size_t)size, "%s/.local/share/termv", env) < size;
+    return 0;
+}
+
+ScoreStore *scores_open(const char *dir) {
+    char lock_path[512];
+    if (!scores_make_dir(dir))
+        return NULL;
+
+    ScoreStore *s = calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    s->log_fd = s->lock_fd = s->idx_fd = -1;
+    snprintf(s->log_path, sizeof(s->log_path), "%s/%s", dir, LOG_NAME);
+    snprintf(s->idx_path, sizeof(s->idx_path), "%s/%s", dir, IDX_NAME);
+    snprintf(lock_path, sizeof(lock_path), "%s/%s", dir, LOCK_NAME);
+
+    s->log_fd = open(s->log_path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    s->lock_fd = open(lock_path, O_RDWR | O_CREAT, 0644);
+    if (s->log_fd < 0 || s->lock_fd < 0 || !index_attach(s)) {
+        scores_close(s);
+        return NULL;
+    }
+    return s;
+}
+
+void scores_close(ScoreStore *s) {
+    if (!s)
+        return;
+    index_unmap(s);
+    if (s->log_fd >= 0)
+        close(s->log_fd);
+    if (s->lock_fd >= 0)
+        close(s->lock_fd);
+    free(s);
+}
+
+int scores_record(ScoreStore *s, uint32_t mode, uint32_t seed, const ScoreEntry *e) {
+    LogRecord r;
+    memset(&r, 0, sizeof(r));
+    r.magic = LOG_MAGIC;
+    r.mode = mode;
+    r.seed = seed;
+    r.entry = *e;
+    r.check = record_check(&r);
+
+    if (write(s->log_fd, &r, sizeof(r)) != (ssize_t)sizeof(r))
+        return 0;
+    off_t end = lseek(s->log_fd, 0, SEEK_CUR);  /* O_APPEND: just past our record */
+
+    for (int attempt = 0; attempt < 8; attempt++) {
+        if (!index_attach(s))
+            return 0;
+
+        /* Shared header lock only keeps a rebuild from running underneath us */
+        range_lock(s->idx_fd, F_RDLCK, 0, (off_t)sizeof(IndexHeader));
+        if (__atomic_load_n(&s->idx->retired, __ATOMIC_ACQUIRE)) {
+            range_lock(s->idx_fd, F_UNLCK, 0, (off_t)sizeof(IndexHeader));
+            continue;
+        }
+        int indexed = end > 0 && (uint64_t)end <= s->idx->log_end;
+        IndexBucket *seed_list = find_bucket(s, mode, seed, 0, !indexed);
+        IndexBucket *any_list = find_bucket(s, mode, 0, 1, !indexed);
+        if (!indexed && (!seed_list || !any_list) && s->bucket_count < IDX_MAX_BUCKETS) {
+            range_lock(s->idx_fd, F_UNLCK, 0, (off_t)sizeof(IndexHeader));
+            if (!index_replace(s, s->bucket_count * 2))
+                return 0;
+            continue;
+        }
+
+        int rank = 0;
+        if (seed_list)
+            locked_insert(s, seed_list, e, indexed);
+        if (any_list)
+            rank = locked_insert(s, any_list, e, indexed);
+        range_lock(s->idx_fd, F_UNLCK, 0, (off_t)sizeof(IndexHeader));
+        return rank;
+    }
+    return 0;
+}
+
+int scores_top(ScoreStore *s, uint32_t mode, uint32_t seed, int any_seed,
+               ScoreEntry *out, int max) {
+    if (!index_attach(s))
+        return 0;
+    IndexBucket *b = find_bucket(s, mode, seed, any_seed ? 1 : 0, 0);
+    if (!b || max <= 0)
+        return 0;
+    if (max > SCORES_TOP_K)
+        max = SCORES_TOP_K;
+
+    /* Seqlock read: retry if a writer was active during the copy */
+    for (int attempt = 0; attempt < 100; attempt++) {
+        uint32_t before = __atomic_load_n(&b->seq, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            sched_yield();
+            continue;
+        }
+        int n = (int)b->count;
+        if (n > max)
+            n = max;
+        memcpy(out, b->entries, (size_t)n * sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&b->seq, __ATOMIC_RELAXED) == before)
+            return n;
+    }
+    return 0;
+}
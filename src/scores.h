@@ -0,0 +1,58 @@
+#ifndef SCORES_H
+#define SCORES_H
+
+#include <stdint.h>
+
+/*
+ * Local leaderboard shared by every termv process on the host.
+ *
+ *   scores.log  append-only records, one write() each, checksummed
+ *   scores.idx  memory-mapped table of top-K lists per (mode, seed), plus
+ *               one list per mode across all seeds
+ *   scores.lock held while the index is rebuilt
+ *
+ * Writers append to the log, then insert into their two index lists
+ * while holding a byte-range lock on just those lists. Readers copy a
+ * list straight out of the mapping under a sequence counter, with no
+ * locking and no log scan. The index is derived data: if it is missing or
+ * damaged, or too full to take a new list, a larger one is built from the
+ * log (skipping torn records) in a new file and renamed into place. The
+ * old file is marked retired, and every process moves to the new one.
+ */
+
+#define SCORES_TOP_K          100
+#define SCORES_MODE_MARATHON  0
+
+typedef struct {
+    uint32_t score;
+    uint32_t lines;
+    uint32_t level;
+    uint32_t time;   /* Unix time the game ended */
+} ScoreEntry;
+
+typedef struct ScoreStore ScoreStore;
+
+/* Open (creating if needed) the store in dir. Returns NULL on failure. */
+ScoreStore *scores_open(const char *dir);
+void        scores_close(ScoreStore *s);
+
+/*
+ * Record a finished game. Returns its 1-based rank in the mode's all-seed
+ * list, or 0 if it did not make the top K.
+ */
+int  scores_record(ScoreStore *s, uint32_t mode, uint32_t seed, const ScoreEntry *e);
+
+/*
+ * Copy up to max entries of a top-K list, best first. With any_seed set,
+ * seed is ignored and the mode's all-seed list is read. Returns the count.
+ */
+int  scores_top(ScoreStore *s, uint32_t mode, uint32_t seed, int any_seed,
+                ScoreEntry *out, int max);
+
+/* Default store directory: $TERMV_HOME, else $XDG_DATA_HOME/termv, else ~/.local/share/termv. */
+int  scores_default_dir(char *buf, int size);
+
+/* Create dir and any missing parents. Returns 0 on failure. */
+int  scores_make_dir(const char *dir);
+
+#endif
@@ -0,0 +1,320 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "seedfind.h"
+#include "game.h"
+#include "rng.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+
+#define MAX_TERMS     16
+#define CHUNK_BITS    22                       /* 4M seeds per claim */
+#define CHUNK_COUNT   (1u << (32 - CHUNK_BITS))
+#define SHOWN_PIECES  14                       /* printed per matching seed */
+#define ALL_PIECES    ((1u << PIECE_COUNT) - 1)
+
+/* ── Queries ─────────────────────────────────────────────────────── */
+
+typedef struct {
+    unsigned char allowed[SEEDFIND_MAX_PIECES];  /* piece-type mask per position */
+    int           span;                          /* pieces dealt to decide a seed */
+    unsigned char need_mask[MAX_TERMS];          /* "T<3": one of these ... */
+    int           need_within[MAX_TERMS];        /* ... among this many pieces */
+    int           need_count;
+} Query;
+
+/* Piece-type mask of the letters at s; .'s are any piece if dots is set. */
+static int parse_pieces(const char **s, int dots, unsigned char *masks, int max) {
+    int n = 0;
+    for (;; (*s)++) {
+        const char *letter = **s ? strchr(PIECE_LETTERS, **s) : NULL;
+        if (!letter && !(dots && **s == '.'))
+            return n;
+        if (n == max)
+            return -1;
+        masks[n++] = letter ? (unsigned char)(1u << (letter - PIECE_LETTERS)) : ALL_PIECES;
+    }
+}
+
+/* Parse "IT.O,T<3,!SZ<21". Returns 0 on error. */
+static int parse_query(const char *s, Query *q) {
+    memset(q->allowed, ALL_PIECES, sizeof(q->allowed));
+    q->span = 0;
+    q->need_count = 0;
+
+    while (*s) {
+        int negate = *s == '!';
+        s += negate;
+        unsigned char masks[SEEDFIND_MAX_PIECES];
+        int n = parse_pieces(&s, !negate, masks, SEEDFIND_MAX_PIECES);
+        if (n <= 0)
+            return 0;
+
+        if (*s == '<') {
+            char *end;
+            long within = strtol(s + 1, &end, 10);
+            if (end == s + 1 || within < 1 || within > SEEDFIND_MAX_PIECES)
+                return 0;
+            s = end;
+            unsigned char set = 0;
+            for (int i = 0; i < n; i++)
+                set |= masks[i];
+            if (negate) {
+                for (int i = 0; i < within; i++)
+                    q->allowed[i] &= (unsigned char)~set;
+            } else {
+                if (q->need_count == MAX_TERMS)
+                    return 0;
+                q->need_mask[q->need_count] = set;
+                q->need_within[q->need_count++] = (int)within;
+            }
+            if (within > q->span)
+                q->span = (int)within;
+        } else {
+            if (negate)
+                return 0;  /* "!" needs a range */
+            for (int i = 0; i < n; i++)
+                q->allowed[i] &= masks[i];
+            if (n > q->span)
+                q->span = n;
+        }
+
+        if (*s == ',')
+            s++;
+        else if (*s)
+            return 0;
+    }
+    return q->span > 0;
+}
+
+/*
+ * Whether any bag order fits the opening and exclusions. Each bag deals
+ * every piece once, so k positions of a bag must allow k pieces between
+ * them (Hall's condition); "!SZ<21" fails it and would scan all 2^32
+ * seeds for nothing.
+ */
+static int query_possible(const Query *q) {
+    for (int p = 0; p < q->span; p += 7) {
+        for (unsigned subset = 1; subset < 128; subset++) {
+            unsigned pieces = 0;
+            for (int i = 0; i < 7; i++) {
+                if (subset >> i & 1)
+                    pieces |= q->allowed[p + i];
+            }
+            if (__builtin_popcount(pieces) < __builtin_popcount(subset))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Deal seed's bags until the query is decided. Whole bags are dealt at a
+ * time (bag_draw shuffles all seven at once), and the first piece out of
+ * place rejects the seed. *bags counts the bags dealt.
+ */
+static int seed_matches(const Query *q, uint32_t seed, uint64_t *bags) {
+    Rng rng;
+    PieceType bag[7];
+    unsigned met = 0;
+
+    rng_seed(&rng, seed);
+    for (int p = 0; p < q->span; p += 7) {
+        int index = 7;
+        bag_draw(bag, &index, &rng);
+        (*bags)++;
+        int end = q->span - p < 7 ? q->span - p : 7;
+        for (int i = 0; i < end; i++) {
+            unsigned bit = 1u << bag[i];
+            if (!(q->allowed[p + i] & bit))
+                return 0;
+            for (int t = 0; t < q->need_count; t++) {
+                if (p + i < q->need_within[t] && (q->need_mask[t] & bit))
+                    met |= 1u << t;
+            }
+        }
+    }
+    return met == (1u << q->need_count) - 1;
+}
+
+/* ── Search ──────────────────────────────────────────────────────── */
+
+typedef struct {
+    const Query    *query;
+    int             limit;
+    pthread_mutex_t lock;
+
+    /* Under lock */
+    uint32_t       *found;          /* matches kept, unordered */
+    size_t          found_count, found_cap;
+    uint32_t        chunk_matches[CHUNK_COUNT];
+    unsigned char   chunk_done[CHUNK_COUNT];
+    uint64_t        total_matches;
+
+    /* Atomic */
+    uint32_t        next_chunk;
+    uint32_t        last_chunk;     /* no chunk past this is needed */
+    uint64_t        seeds, bags;
+} Search;
+
+/* Record a finished chunk: keep its first limit matches and move the cutoff. */
+static int finish_chunk(Search *s, uint32_t chunk, const uint32_t *seeds,
+                        uint32_t kept, uint32_t matches) {
+    int ok = 1;
+    pthread_mutex_lock(&s->lock);
+    if (s->found_count + kept > s->found_cap) {
+        size_t cap = s->found_cap * 2 + kept;
+        uint32_t *grown = realloc(s->found, cap * sizeof(*grown));
+        if (grown) {
+            s->found = grown;
+            s->found_cap = cap;
+        } else {
+            ok = 0;
+        }
+    }
+    if (ok) {
+        memcpy(s->found + s->found_count, seeds, kept * sizeof(*seeds));
+        s->found_count += kept;
+        s->chunk_matches[chunk] = matches;
+        s->chunk_done[chunk] = 1;
+        s->total_matches += matches;
+
+        /* Once the chunks up to c are done and hold limit matches, nothing past c counts */
+        uint64_t before = 0;
+        for (uint32_t c = 0; s->limit > 0 && c < CHUNK_COUNT && s->chunk_done[c]; c++) {
+            before += s->chunk_matches[c];
+            if (before >= (uint64_t)s->limit) {
+                __atomic_store_n(&s->last_chunk, c, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+    return ok;
+}
+
+static void *search_main(void *arg) {
+    Search *s = arg;
+    uint32_t *kept = malloc((size_t)(s->limit > 0 ? s->limit : 1) * sizeof(*kept));
+    if (!kept)
+        return NULL;  /* the other workers take its chunks */
+
+    for (;;) {
+        uint32_t chunk = __atomic_fetch_add(&s->next_chunk, 1, __ATOMIC_RELAXED);
+        if (chunk >= CHUNK_COUNT || chunk > __atomic_load_n(&s->last_chunk, __ATOMIC_RELAXED))
+            break;
+
+        uint32_t first = chunk << CHUNK_BITS;
+        uint32_t matches = 0, count = 0;
+        uint64_t bags = 0;
+        for (uint32_t i = 0; i < (1u << CHUNK_BITS); i++) {
+            if (seed_matches(s->query, first + i, &bags)) {
+                if ((int)count < s->limit)
+                    kept[count++] = first + i;
+                matches++;
+            }
+        }
+        __atomic_fetch_add(&s->seeds, (uint64_t)1 << CHUNK_BITS, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s->bags, bags, __ATOMIC_RELAXED);
+        if (!finish_chunk(s, chunk, kept, count, matches))
+            break;
+    }
+    free(kept);
+    return NULL;
+}
+
+static int compare_seeds(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+int seedfind_run(const SeedFindOptions *opt) {
+    static Search search;
+    Search *s = &search;
+    Query query;
+
+    if (!parse_query(opt->query, &query)) {
+        fprintf(stderr, "termv: bad seed query '%s' (terms: IT.O, T<3, !SZ<21; "
+                        "pieces %s, at most %d)\n",
+                opt->query, PIECE_LETTERS, SEEDFIND_MAX_PIECES);
+        return 1;
+    }
+
+    if (!query_possible(&query)) {
+        fprintf(stderr, "termv: no seed can match '%s': every bag deals each piece once\n",
+                opt->query);
+        return 1;
+    }
+
+    int threads = util_thread_count(opt->threads);
+
+    memset(s, 0, sizeof(*s));
+    s->query = &query;
+    s->limit = opt->limit > 0 ? opt->limit : 0;
+    s->last_chunk = CHUNK_COUNT - 1;
+    pthread_mutex_init(&s->lock, NULL);
+
+    double started = util_now_seconds();
+    pthread_t tids[UTIL_MAX_THREADS];
+    int spawned = 1;
+    for (; spawned < threads; spawned++) {
+        if (pthread_create(&tids[spawned], NULL, search_main, s) != 0)
+            break;
+    }
+    search_main(s);
+    for (int i = 1; i < spawned; i++)
+        pthread_join(tids[i], NULL);
+    double elapsed = util_now_seconds() - started;
+
+    /* Every chunk is accounted for unless a worker ran out of memory */
+    uint32_t needed = s->last_chunk + 1;
+    int complete = 1;
+    for (uint32_t c = 0; c < needed; c++)
+        complete &= s->chunk_done[c];
+    if (!complete) {
+        fprintf(stderr, "termv: out of memory\n");
+        free(s->found);
+        pthread_mutex_destroy(&s->lock);
+        return 1;
+    }
+
+    qsort(s->found, s->found_count, sizeof(*s->found), compare_seeds);
+    size_t shown = s->limit > 0 && s->found_count > (size_t)s->limit
+                 ? (size_t)s->limit : s->found_count;
+    if (s->limit > 0) {
+        for (size_t i = 0; i < shown; i++) {
+            PieceType pieces[SHOWN_PIECES];
+            char text[SHOWN_PIECES + SHOWN_PIECES / 7 + 1];
+            int n = 0;
+            bag_sequence(s->found[i], 0, pieces, SHOWN_PIECES);
+            for (int k = 0; k < SHOWN_PIECES; k++) {
+                if (k > 0 && k % 7 == 0)
+                    text[n++] = ' ';
+                text[n++] = PIECE_LETTERS[pieces[k]];
+            }
+            text[n] = '\0';
+            printf("%10u  %s\n", s->found[i], text);
+        }
+    }
+
+    uint64_t seeds = s->seeds, draws = s->bags * BAG_DRAWS;
+    if (shown < (size_t)s->limit || s->limit == 0)
+        printf("%llu of %llu seeds match \"%s\"", (unsigned long long)s->total_matches,
+               (unsigned long long)seeds, opt->query);
+    else
+        printf("first %zu seeds matching \"%s\" (%llu seeds scanned)", shown, opt->query,
+               (unsigned long long)seeds);
+    printf(" in %.3f s, %d thread%s: %.0f M seeds/s, %.2f G draws/s\n",
+           elapsed, threads, threads == 1 ? "" : "s",
+           elapsed > 0 ? seeds / elapsed / 1e6 : 0.0,
+           elapsed > 0 ? draws / elapsed / 1e9 : 0.0);
+
+    free(s->found);
+    pthread_mutex_destroy(&s->lock);
+    return 0;
+}
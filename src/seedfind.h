@@ -0,0 +1,32 @@
+#ifndef SEEDFIND_H
+#define SEEDFIND_H
+
+/*
+ * Seed search (`termv --find-seed QUERY`): scan the 32-bit seed space for
+ * seeds whose piece sequence meets a query, for curated tournament and
+ * practice seeds. Only the PRNG and 7-bag shuffle run; no game is
+ * simulated. Piece 0 is the first piece played.
+ *
+ * A query is comma-separated terms, all of which must hold:
+ *
+ *   IT.O      opening: piece k is the k-th letter, '.' is any piece
+ *   T<3       one of the listed pieces within the first 3
+ *   !SZ<21    none of the listed pieces within the first 21 (3 bags)
+ *
+ * Seeds are scanned in chunks claimed by worker threads. Matches are
+ * reported in seed order, so a search gives the same seeds however many
+ * threads run it.
+ */
+
+#define SEEDFIND_MAX_PIECES 70   /* 10 bags: the furthest a term can look */
+
+typedef struct {
+    const char *query;
+    int         limit;     /* stop after this many seeds, 0 = count all */
+    int         threads;   /* 0 = one per online CPU */
+} SeedFindOptions;
+
+/* Run the search and print matches to stdout. Returns a process exit status. */
+int seedfind_run(const SeedFindOptions *opt);
+
+#endif
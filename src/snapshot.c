@@ -0,0 +1,290 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "snapshot.h"
+#include "board.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define SNAPSHOT_MAGIC   "TMVS"
+#define SNAPSHOT_VERSION 5
+
+#define PACKED_BOARD_SIZE ((BOARD_HEIGHT * BOARD_WIDTH * 3 + 7) / 8)
+
+/* ── Little-endian writer / reader ───────────────────────────────── */
+
+typedef struct {
+    unsigned char *buf;
+    size_t cap;
+    size_t pos;
+    int    ok;
+} Writer;
+
+typedef struct {
+    const unsigned char *buf;
+    size_t len;
+    size_t pos;
+    int    ok;
+} Reader;
+
+static void put_u8(Writer *w, unsigned v) {
+    if (w->pos + 1 > w->cap) {
+        w->ok = 0;
+        return;
+    }
+    w->buf[w->pos++] = (unsigned char)v;
+}
+
+static void put_u32(Writer *w, uint32_t v) {
+    for (int i = 0; i < 4; i++)
+        put_u8(w, (v >> (8 * i)) & 0xFF);
+}
+
+static void put_u64(Writer *w, uint64_t v) {
+    put_u32(w, (uint32_t)v);
+    put_u32(w, (uint32_t)(v >> 32));
+}
+
+static void put_f64(Writer *w, double d) {
+    uint64_t v;
+    memcpy(&v, &d, sizeof(v));
+    put_u64(w, v);
+}
+
+static unsigned get_u8(Reader *r) {
+    if (r->pos + 1 > r->len) {
+        r->ok = 0;
+        return 0;
+    }
+    return r->buf[r->pos++];
+}
+
+static uint32_t get_u32(Reader *r) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++)
+        v |= (uint32_t)get_u8(r) << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(Reader *r) {
+    uint64_t lo = get_u32(r);
+    uint64_t hi = get_u32(r);
+    return lo | (hi << 32);
+}
+
+static double get_f64(Reader *r) {
+    uint64_t v = get_u64(r);
+    double d;
+    memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+/* ── Board packing (3 bits per cell, row-major) ──────────────────── */
+
+static void pack_board(Writer *w, const Board *b) {
+    unsigned char packed[PACKED_BOARD_SIZE];
+    memset(packed, 0, sizeof(packed));
+
+    int bit = 0;
+    for (int r = 0; r < BOARD_HEIGHT; r++) {
+        const int *row = board_row(b, r);
+        for (int c = 0; c < BOARD_WIDTH; c++, bit += 3) {
+            /* Only piece colors fit; a wider id would come back empty */
+            if (row[c] < 0 || row[c] > 7)
+                w->ok = 0;
+            unsigned v = (unsigned)row[c] & 7;
+            packed[bit / 8] |= (unsigned char)(v << (bit % 8));
+            if (bit % 8 > 5)
+                packed[bit / 8 + 1] |= (unsigned char)(v >> (8 - bit % 8));
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(packed); i++)
+        put_u8(w, packed[i]);
+}
+
+static void unpack_board(Reader *r, Board *b) {
+    unsigned char packed[PACKED_BOARD_SIZE];
+    for (size_t i = 0; i < sizeof(packed); i++)
+        packed[i] = (unsigned char)get_u8(r);
+    if (!r->ok)
+        return;
+
+    board_init(b);
+    int bit = 0;
+    for (int row = 0; row < BOARD_HEIGHT; row++) {
+        for (int c = 0; c < BOARD_WIDTH; c++, bit += 3) {
+            unsigned v = packed[bit / 8] >> (bit % 8);
+            if (bit % 8 > 5)
+                v |= (unsigned)packed[bit / 8 + 1] << (8 - bit % 8);
+            if (v & 7)
+                board_set(b, row, c, (int)(v & 7));
+        }
+    }
+}
+
+/* ── Public API ───────────────────────────────────────────────────── */
+
+size_t snapshot_encode(const Game *g, unsigned char *buf, size_t cap) {
+    Writer w = { buf, cap, 0, 1 };
+
+    for (int i = 0; i < 4; i++)
+        put_u8(&w, (unsigned char)SNAPSHOT_MAGIC[i]);
+    put_u8(&w, SNAPSHOT_VERSION);
+
+    put_u8(&w, (unsigned)g->state);
+    put_u8(&w, (unsigned)g->current.type);
+    put_u8(&w, (unsigned)g->current.rotation & 3);
+    put_u32(&w, (uint32_t)g->current.row);
+    put_u32(&w, (uint32_t)g->current.col);
+    put_u8(&w, (unsigned)g->next);
+    put_u8(&w, (unsigned)g->rotation);
+    put_u32(&w, (uint32_t)g->score);
+    put_u32(&w, (uint32_t)g->lines);
+    put_u32(&w, (uint32_t)g->level);
+    put_u8(&w, (unsigned)(g->soft_dropping != 0)
+               | (unsigned)(g->locking != 0) << 1
+               | (unsigned)(g->flash_active != 0) << 2);
+
+    for (int i = 0; i < 7; i++)
+        put_u8(&w, (unsigned)g->bag[i]);
+    put_u8(&w, (unsigned)g->bag_index);
+    put_u32(&w, g->seed);
+    put_u64(&w, g->rng.state);
+    put_u64(&w, g->rng.inc);
+
+    put_f64(&w, g->gravity_interval);
+    put_f64(&w, g->gravity_timer);
+    put_f64(&w, g->lock_delay);
+    put_f64(&w, g->lock_timer);
+    put_f64(&w, g->flash_timer);
+    put_u8(&w, (unsigned)g->flash_count);
+
+    put_u32(&w, g->stats.pieces);
+    put_u32(&w, g->stats.keys);
+    put_u32(&w, g->stats.finesse_faults);
+    for (int i = 0; i < 4; i++)
+        put_u32(&w, g->stats.clears[i]);
+    put_u8(&w, (unsigned)g->stats.max_height);
+    put_u32(&w, (uint32_t)g->stats.piece_inputs);
+    put_f64(&w, g->stats.time_ms);
+
+    pack_board(&w, &g->board);
+
+    return w.ok ? w.pos : 0;
+}
+
+int snapshot_decode(Game *g, const unsigned char *buf, size_t len) {
+    Reader r = { buf, len, 0, 1 };
+    Game tmp;
+
+    for (int i = 0; i < 4; i++) {
+        if (get_u8(&r) != (unsigned char)SNAPSHOT_MAGIC[i])
+            return 0;
+    }
+    if (get_u8(&r) != SNAPSHOT_VERSION)
+        return 0;
+
+    tmp.state = (GameState)get_u8(&r);
+    tmp.current.type = (PieceType)get_u8(&r);
+    tmp.current.rotation = (int)get_u8(&r);
+    tmp.current.row = (int)get_u32(&r);
+    tmp.current.col = (int)get_u32(&r);
+    tmp.next = (PieceType)get_u8(&r);
+    tmp.rotation = (RotationSystem)get_u8(&r);
+    tmp.current.system = tmp.rotation;
+    tmp.score = (int)get_u32(&r);
+    tmp.lines = (int)get_u32(&r);
+    tmp.level = (int)get_u32(&r);
+    unsigned flags = get_u8(&r);
+    tmp.soft_dropping = flags & 1;
+    tmp.locking = (flags >> 1) & 1;
+    tmp.flash_active = (flags >> 2) & 1;
+
+    for (int i = 0; i < 7; i++)
+        tmp.bag[i] = (PieceType)get_u8(&r);
+    tmp.bag_index = (int)get_u8(&r);
+    tmp.seed = get_u32(&r);
+    tmp.rng.state = get_u64(&r);
+    tmp.rng.inc = get_u64(&r);
+
+    tmp.gravity_interval = get_f64(&r);
+    tmp.gravity_timer = get_f64(&r);
+    tmp.lock_delay = get_f64(&r);
+    tmp.lock_timer = get_f64(&r);
+    tmp.flash_timer = get_f64(&r);
+    tmp.flash_count = (int)get_u8(&r);
+
+    stats_init(&tmp.stats);
+    tmp.stats.pieces = get_u32(&r);
+    tmp.stats.keys = get_u32(&r);
+    tmp.stats.finesse_faults = get_u32(&r);
+    for (int i = 0; i < 4; i++)
+        tmp.stats.clears[i] = get_u32(&r);
+    tmp.stats.max_height = (int)get_u8(&r);
+    tmp.stats.piece_inputs = (int)get_u32(&r);
+    tmp.stats.time_ms = get_f64(&r);
+
+    if (!r.ok || tmp.state > STATE_QUIT || tmp.current.type >= PIECE_COUNT
+        || tmp.next >= PIECE_COUNT || tmp.rotation >= ROTATION_COUNT
+        || tmp.bag_index > 7 || !(tmp.rng.inc & 1))
+        return 0;
+    for (int i = tmp.bag_index; i < 7; i++) {
+        if (tmp.bag[i] >= PIECE_COUNT)
+            return 0;  /* still to be dealt */
+    }
+
+    unpack_board(&r, &tmp.board);
+    if (!r.ok)
+        return 0;
+
+    *g = tmp;
+    return 1;
+}
+
+/*
+ * Written to a new file beside path and renamed over it, so a reader
+ * never sees half a snapshot. O_EXCL and O_NOFOLLOW keep the write from
+ * landing anywhere a planted symlink points.
+ */
+int snapshot_save(const Game *g, const char *path) {
+    unsigned char buf[SNAPSHOT_MAX_SIZE];
+    size_t len = snapshot_encode(g, buf, sizeof(buf));
+    if (len == 0)
+        return 0;
+
+    char tmp_path[512];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", path, (long)getpid())
+        >= (int)sizeof(tmp_path))
+        return 0;
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0600);
+    if (fd < 0)
+        return 0;
+    int ok = write(fd, buf, len) == (ssize_t)len;
+    ok &= fsync(fd) == 0;
+    ok &= close(fd) == 0;
+    if (ok && rename(tmp_path, path) == 0)
+        return 1;
+    unlink(tmp_path);
+    return 0;
+}
+
+int snapshot_load(Game *g, const char *path) {
+    unsigned char buf[SNAPSHOT_MAX_SIZE];
+    int fd = open(path, O_RDONLY | O_NOFOLLOW);
+    if (fd < 0)
+        return 0;
+
+    /* Only a regular file of our own: anyone else's could be crafted */
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_uid != geteuid()) {
+        close(fd);
+        return 0;
+    }
+    ssize_t len = read(fd, buf, sizeof(buf));
+    close(fd);
+    return len > 0 && snapshot_decode(g, buf, (size_t)len);
+}
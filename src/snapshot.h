@@ -0,0 +1,33 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include "game.h"
+
+/*
+ * Compact binary form of a game: the Game struct, the board packed at
+ * 3 bits per cell, bag contents, generator state and play statistics.
+ * Multi-byte fields are little-endian so snapshots move between hosts.
+ */
+
+/* Upper bound on an encoded snapshot, in bytes. */
+#define SNAPSHOT_MAX_SIZE 320
+
+/*
+ * Encode g into buf. Returns bytes written, 0 if cap is too small or the
+ * board holds a color id outside 0-7 (such as netplay garbage).
+ */
+size_t snapshot_encode(const Game *g, unsigned char *buf, size_t cap);
+
+/* Restore g from buf. Returns 1 on success, 0 if buf is not a valid snapshot. */
+int    snapshot_decode(Game *g, const unsigned char *buf, size_t len);
+
+/*
+ * File wrappers around encode/decode. Return 1 on success, 0 on failure.
+ * Saving replaces path atomically; loading accepts only a regular file
+ * owned by the caller.
+ */
+int    snapshot_save(const Game *g, const char *path);
+int    snapshot_load(Game *g, const char *path);
+
+#endif
@@ -0,0 +1,157 @@
+#include "stats.h"
+#include <string.h>
+
+/* Reference columns a piece can occupy: the 4x4 box may hang off either wall */
+#define COL_MIN     (-3)
+#define COL_SPAN    (BOARD_WIDTH + 4)
+#define STATE_COUNT (4 * COL_SPAN)
+
+/* ── Finesse ─────────────────────────────────────────────────────── */
+
+/*
+ * Placement footprint independent of height: cell columns and rows
+ * relative to the piece's top cell, as a bitmask of 4 rows x BOARD_WIDTH.
+ * Rotations that cover the same cells (O, or I/S/Z shifted by a row)
+ * therefore count as the same placement.
+ */
+static uint64_t footprint(const Piece *p) {
+    int cells[4][2];
+    piece_get_cells(p, cells);
+
+    int top = cells[0][0];
+    for (int i = 1; i < 4; i++) {
+        if (cells[i][0] < top)
+            top = cells[i][0];
+    }
+
+    uint64_t key = 0;
+    for (int i = 0; i < 4; i++)
+        key |= (uint64_t)1 << ((cells[i][0] - top) * BOARD_WIDTH + cells[i][1]);
+    return key;
+}
+
+static int state_index(const Piece *p) {
+    return p->rotation * COL_SPAN + (p->col - COL_MIN);
+}
+
+int stats_finesse_optimal(const Piece *p) {
+    Board empty;
+    Piece queue[STATE_COUNT];
+    int dist[STATE_COUNT];
+    int head = 0, tail = 0;
+    uint64_t target = footprint(p);
+
+    board_init(&empty);
+    for (int i = 0; i < STATE_COUNT; i++)
+        dist[i] = -1;
+
+    /* Breadth-first over (rotation, column) at the spawn row */
+    piece_spawn(&queue[tail], p->type, p->system);
+    dist[state_index(&queue[tail])] = 0;
+    tail++;
+
+    while (head < tail) {
+        Piece cur = queue[head++];
+        int d = dist[state_index(&cur)];
+        if (footprint(&cur) == target)
+            return d;
+
+        for (int move = 0; move < 4; move++) {
+            Piece next = cur;
+            int ok;
+            if (move < 2) {
+                next.col += move == 0 ? -1 : 1;
+                ok = piece_valid(&empty, &next);
+            } else {
+                ok = piece_try_rotate(&empty, &next, move == 2 ? 1 : -1);
+            }
+            if (!ok || next.row != cur.row)
+                continue;
+
+            int idx = state_index(&next);
+            if (dist[idx] < 0) {
+                dist[idx] = d + 1;
+                queue[tail++] = next;
+            }
+        }
+    }
+    return -1;
+}
+
+/* ── Counters ────────────────────────────────────────────────────── */
+
+void stats_init(GameStats *s) {
+    memset(s, 0, sizeof(*s));
+    s->last_type = -1;
+    s->last_optimal = -1;
+}
+
+void stats_input(GameStats *s) {
+    s->keys++;
+    s->piece_inputs++;
+}
+
+void stats_hard_drop(GameStats *s) {
+    s->keys++;
+}
+
+void stats_piece_locked(GameStats *s, const Board *b, const Piece *p) {
+    int height = 0;
+    for (int r = 0; r < BOARD_HEIGHT; r++) {
+        if (board_row_bits(b, r)) {
+            height = BOARD_HEIGHT - r;
+            break;
+        }
+    }
+
+    s->pieces++;
+    s->last_type = (int)p->type;
+    s->last_inputs = s->piece_inputs;
+    s->last_optimal = stats_finesse_optimal(p);
+    s->last_cleared = 0;
+    s->last_height = height;
+    if (height > s->max_height)
+        s->max_height = height;
+    if (s->last_optimal >= 0 && s->last_inputs > s->last_optimal)
+        s->finesse_faults++;
+    s->piece_inputs = 0;
+}
+
+void stats_lines_cleared(GameStats *s, int lines) {
+    s->last_cleared = lines;
+    if (lines >= 1 && lines <= 4)
+        s->clears[lines - 1]++;
+}
+
+double stats_pps(const GameStats *s) {
+    return s->time_ms > 0.0 ? s->pieces * 1000.0 / s->time_ms : 0.0;
+}
+
+double stats_kpp(const GameStats *s) {
+    return s->pieces > 0 ? (double)s->keys / s->pieces : 0.0;
+}
+
+/* ── JSON lines ──────────────────────────────────────────────────── */
+
+int stats_write_json(FILE *f, const GameStats *s, const char *event) {
+    int n = fprintf(f, "{\"event\":\"%s\",\"t_ms\":%.0f,\"pieces\":%u,"
+                       "\"pps\":%.3f,\"kpp\":%.3f,\"faults\":%u,"
+                       "\"clears\":[%u,%u,%u,%u],\"max_height\":%d",
+                    event, s->time_ms, (unsigned)s->pieces,
+                    stats_pps(s), stats_kpp(s), (unsigned)s->finesse_faults,
+                    (unsigned)s->clears[0], (unsigned)s->clears[1],
+                    (unsigned)s->clears[2], (unsigned)s->clears[3],
+                    s->max_height);
+    if (n < 0)
+        return 0;
+
+    if (strcmp(event, "piece") == 0 && s->last_type >= 0) {
+        n = fprintf(f, ",\"piece\":\"%c\",\"inputs\":%d,\"optimal\":%d,"
+                       "\"cleared\":%d,\"height\":%d",
+                    PIECE_LETTERS[s->last_type], s->last_inputs,
+                    s->last_optimal, s->last_cleared, s->last_height);
+        if (n < 0)
+            return 0;
+    }
+    return fputs("}\n", f) >= 0;
+}
@@ -0,0 +1,65 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "piece.h"
+
+/*
+ * Per-game play statistics, updated by the engine as the game runs:
+ * pieces per second, keys per piece, finesse faults, the line clear
+ * breakdown and peak stack height.
+ *
+ * Finesse compares the shifts and rotations spent on each piece against
+ * the fewest that reach the same placement from spawn on an open field.
+ */
+
+typedef struct {
+    uint32_t pieces;
+    uint32_t keys;            /* shifts, rotations and hard drops */
+    uint32_t finesse_faults;  /* pieces placed with more inputs than needed */
+    uint32_t clears[4];       /* singles, doubles, triples, tetrises */
+    int      max_height;      /* tallest stack seen, in rows */
+    double   time_ms;         /* time spent running */
+
+    /* Current piece */
+    int      piece_inputs;    /* shifts and rotations since spawn */
+
+    /* Most recent placement */
+    int      last_type;
+    int      last_inputs;
+    int      last_optimal;    /* -1 if the placement is not reachable from spawn */
+    int      last_cleared;
+    int      last_height;
+} GameStats;
+
+void stats_init(GameStats *s);
+
+/* One shift or rotation key press (counts even if the move was blocked). */
+void stats_input(GameStats *s);
+
+/* One hard drop key press. */
+void stats_hard_drop(GameStats *s);
+
+/* Piece p has just been locked into b, before lines are cleared. */
+void stats_piece_locked(GameStats *s, const Board *b, const Piece *p);
+
+/* Lines cleared by the piece just locked. */
+void stats_lines_cleared(GameStats *s, int lines);
+
+/*
+ * Fewest shifts and rotations that take a freshly spawned piece of p's
+ * type to p's final footprint. Returns -1 if no sequence does.
+ */
+int  stats_finesse_optimal(const Piece *p);
+
+double stats_pps(const GameStats *s);
+double stats_kpp(const GameStats *s);
+
+/*
+ * Write one JSON object and a newline. event is "piece" for a placement
+ * record or "end" for the final summary. Returns 0 on write error.
+ */
+int  stats_write_json(FILE *f, const GameStats *s, const char *event);
+
+#endif
@@ -0,0 +1,208 @@
+#include "termv.h"
+#include "game.h"
+#include "pc.h"
+#include "snapshot.h"
+#include <stdlib.h>
+
+/* Compile-time checks that the public constants track the engine. */
+#define TERMV_ASSERT(name, cond) typedef char termv_assert_##name[(cond) ? 1 : -1]
+TERMV_ASSERT(width,    TERMV_BOARD_WIDTH == BOARD_WIDTH);
+TERMV_ASSERT(height,   TERMV_BOARD_HEIGHT == BOARD_HEIGHT);
+TERMV_ASSERT(hidden,   TERMV_HIDDEN_HEIGHT == HIDDEN_HEIGHT);
+TERMV_ASSERT(pieces,   (int)TERMV_PIECE_L == (int)PIECE_L);
+TERMV_ASSERT(states,   (int)TERMV_STATE_QUIT == (int)STATE_QUIT);
+TERMV_ASSERT(rotation, (int)TERMV_ROTATION_ARS == (int)ROTATION_ARS);
+TERMV_ASSERT(snapshot, TERMV_SERIALIZED_MAX >= SNAPSHOT_MAX_SIZE);
+
+#define TERMV_QUEUE_LOCAL 64  /* queue pieces peeked without allocating */
+
+struct Termv {
+    Game game;
+    RotationSystem rotation;  /* kept across resets */
+};
+
+Termv *termv_create(unsigned int seed) {
+    Termv *t = malloc(sizeof(*t));
+    if (!t)
+        return NULL;
+    t->rotation = ROTATION_BASIC;
+    game_init(&t->game, seed);
+    return t;
+}
+
+void termv_destroy(Termv *t) {
+    free(t);
+}
+
+void termv_reset(Termv *t, unsigned int seed) {
+    game_init(&t->game, seed);
+    game_set_rotation(&t->game, t->rotation);
+}
+
+void termv_set_rotation(Termv *t, TermvRotation rs) {
+    if ((unsigned)rs >= ROTATION_COUNT)
+        return;
+    t->rotation = (RotationSystem)rs;
+    game_set_rotation(&t->game, t->rotation);
+}
+
+/*
+ * One game_update per tick: it stops at a landing or a lock and drops the
+ * rest of its dt, so one long step must behave like that many short ones.
+ */
+void termv_step(Termv *t, unsigned int ticks) {
+    Game *g = &t->game;
+    for (; ticks > 0; ticks--) {
+        if (g->state != STATE_RUNNING && !g->flash_active)
+            break;  /* nothing left to advance */
+        game_update(g, 1.0);
+    }
+}
+
+int termv_apply(Termv *t, TermvAction action) {
+    Game *g = &t->game;
+
+    switch (action) {
+        case TERMV_ACTION_LEFT:
+            return game_move(g, 0, -1);
+        case TERMV_ACTION_RIGHT:
+            return game_move(g, 0, 1);
+        case TERMV_ACTION_SOFT_DROP:
+            g->soft_dropping = 1;
+            return game_move(g, 1, 0);
+        case TERMV_ACTION_SOFT_DROP_RELEASE:
+            g->soft_dropping = 0;
+            return 1;
+        case TERMV_ACTION_ROTATE_CW:
+            return game_rotate(g, -1);
+        case TERMV_ACTION_ROTATE_CCW:
+            return game_rotate(g, 1);
+        case TERMV_ACTION_HARD_DROP:
+            if (g->state != STATE_RUNNING)
+                return 0;
+            game_hard_drop(g);
+            return 1;
+        case TERMV_ACTION_PAUSE:
+            if (g->state != STATE_RUNNING && g->state != STATE_PAUSED)
+                return 0;
+            game_toggle_pause(g);
+            return 1;
+        case TERMV_ACTION_NONE:
+            break;
+    }
+    return 0;
+}
+
+TermvState termv_state(const Termv *t) {
+    return (TermvState)t->game.state;
+}
+
+int termv_score(const Termv *t) {
+    return t->game.score;
+}
+
+int termv_lines(const Termv *t) {
+    return t->game.lines;
+}
+
+int termv_level(const Termv *t) {
+    return t->game.level;
+}
+
+void termv_board(const Termv *t,
+                 unsigned char out[TERMV_BOARD_HEIGHT * TERMV_BOARD_WIDTH]) {
+    for (int r = 0; r < BOARD_HEIGHT; r++) {
+        const int *row = board_row(&t->game.board, r);
+        for (int c = 0; c < BOARD_WIDTH; c++)
+            out[r * BOARD_WIDTH + c] = (unsigned char)row[c];
+    }
+}
+
+void termv_board_bits(const Termv *t, unsigned short out[TERMV_BOARD_HEIGHT]) {
+    for (int r = 0; r < BOARD_HEIGHT; r++)
+        out[r] = (unsigned short)board_row_bits(&t->game.board, r);
+}
+
+void termv_current(const Termv *t, TermvPiece *out) {
+    out->type = (int)t->game.current.type;
+    out->rotation = t->game.current.rotation;
+    out->row = t->game.current.row;
+    out->col = t->game.current.col;
+}
+
+int termv_next(const Termv *t) {
+    return (int)t->game.next;
+}
+
+void termv_timers(const Termv *t, TermvTimers *out) {
+    const Game *g = &t->game;
+    out->gravity_interval = game_get_gravity_interval(g);
+    out->gravity_timer = g->gravity_timer;
+    out->lock_delay = g->lock_delay;
+    out->lock_timer = g->lock_timer;
+    out->locking = g->locking;
+}
+
+void termv_stats(const Termv *t, TermvStats *out) {
+    const GameStats *s = &t->game.stats;
+    out->pieces = s->pieces;
+    out->keys = s->keys;
+    out->finesse_faults = s->finesse_faults;
+    for (int i = 0; i < 4; i++)
+        out->clears[i] = s->clears[i];
+    out->max_height = s->max_height;
+    out->time_ms = s->time_ms;
+    out->pps = stats_pps(s);
+    out->kpp = stats_kpp(s);
+}
+
+void termv_queue(const Termv *t, int *out, size_t n) {
+    PieceType local[TERMV_QUEUE_LOCAL];
+    PieceType *pieces = n <= TERMV_QUEUE_LOCAL ? local : malloc(n * sizeof(*pieces));
+    if (!pieces)
+        return;
+
+    game_peek_queue(&t->game, pieces, n);
+    for (size_t i = 0; i < n; i++)
+        out[i] = (int)pieces[i];
+    if (pieces != local)
+        free(pieces);
+}
+
+int termv_find_perfect_clear(const Termv *t, int threads, TermvPiece out[9]) {
+    Piece path[PC_MAX_PIECES];
+    int n = pc_find_game(&t->game, threads, path);
+
+    for (int i = 0; i < n; i++) {
+        out[i].type = (int)path[i].type;
+        out[i].rotation = path[i].rotation;
+        out[i].row = path[i].row;
+        out[i].col = path[i].col;
+    }
+    return n;
+}
+
+void termv_piece_sequence(unsigned int seed, unsigned long long start,
+                          int *out, size_t n) {
+    PieceType buf[64];
+    while (n > 0) {
+        size_t chunk = n < 64 ? n : 64;
+        bag_sequence(seed, start, buf, chunk);
+        for (size_t i = 0; i < chunk; i++)
+            out[i] = (int)buf[i];
+        start += chunk;
+        out += chunk;
+        n -= chunk;
+    }
+}
+
+size_t termv_serialize(const Termv *t, unsigned char *buf, size_t cap) {
+    return snapshot_encode(&t->game, buf, cap);
+}
+
+int termv_deserialize(Termv *t, const unsigned char *buf, size_t len) {
+    if (!snapshot_decode(&t->game, buf, len))
+        return 0;
+    t->rotation = t->game.rotation;
+    return 1;
+}
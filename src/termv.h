@@ -0,0 +1,203 @@
+#ifndef TERMV_H
+#define TERMV_H
+
+/*
+ * libtermv: the game engine as a library, with no terminal dependency.
+ *
+ * Each Termv handle is an independent game. The API is plain C with no
+ * engine types exposed, so it stays stable as the internals change.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TERMV_API_VERSION    2
+
+#define TERMV_BOARD_WIDTH    10
+#define TERMV_BOARD_HEIGHT   40  /* Includes the hidden rows above the field */
+#define TERMV_HIDDEN_HEIGHT  20
+
+/* Upper bound on termv_serialize() output, in bytes. */
+#define TERMV_SERIALIZED_MAX 320
+
+typedef struct Termv Termv;
+
+/* Piece types, same order as the in-game colors (color ID = type + 1). */
+typedef enum {
+    TERMV_PIECE_I = 0,
+    TERMV_PIECE_O,
+    TERMV_PIECE_T,
+    TERMV_PIECE_S,
+    TERMV_PIECE_Z,
+    TERMV_PIECE_J,
+    TERMV_PIECE_L
+} TermvPieceType;
+
+typedef enum {
+    TERMV_STATE_INIT = 0,
+    TERMV_STATE_RUNNING,
+    TERMV_STATE_PAUSED,
+    TERMV_STATE_GAMEOVER,
+    TERMV_STATE_QUIT
+} TermvState;
+
+typedef enum {
+    TERMV_ACTION_NONE = 0,
+    TERMV_ACTION_LEFT,
+    TERMV_ACTION_RIGHT,
+    TERMV_ACTION_SOFT_DROP,          /* Move down one row and hold soft drop */
+    TERMV_ACTION_SOFT_DROP_RELEASE,
+    TERMV_ACTION_ROTATE_CW,
+    TERMV_ACTION_ROTATE_CCW,
+    TERMV_ACTION_HARD_DROP,
+    TERMV_ACTION_PAUSE
+} TermvAction;
+
+typedef enum {
+    TERMV_ROTATION_BASIC = 0,  /* original shapes and kicks (default) */
+    TERMV_ROTATION_SRS,        /* Super Rotation System, with the I-piece kicks */
+    TERMV_ROTATION_ARS         /* arcade rotation */
+} TermvRotation;
+
+typedef struct {
+    int type;      /* TermvPieceType */
+    int rotation;  /* 0-3, each +1 a quarter turn counter-clockwise */
+    int row;       /* top-left of the 4x4 bounding box, board coords */
+    int col;
+} TermvPiece;
+
+/* Game timers, in milliseconds. */
+typedef struct {
+    double gravity_interval;  /* current interval between gravity steps */
+    double gravity_timer;     /* time since the last gravity step */
+    double lock_delay;
+    double lock_timer;        /* time spent in lock delay */
+    int    locking;           /* 1 while the piece is resting in lock delay */
+} TermvTimers;
+
+/* Play statistics, maintained as the game runs. */
+typedef struct {
+    unsigned pieces;
+    unsigned keys;            /* shifts, rotations and hard drops */
+    unsigned finesse_faults;  /* pieces placed with more inputs than needed */
+    unsigned clears[4];       /* singles, doubles, triples, tetrises */
+    int      max_height;      /* tallest stack seen, in rows */
+    double   time_ms;         /* running time */
+    double   pps;             /* pieces per second */
+    double   kpp;             /* keys per piece */
+} TermvStats;
+
+/* One simulation tick is one millisecond of game time. */
+Termv *termv_create(unsigned int seed);
+void   termv_destroy(Termv *t);
+
+/* Start a new game on an existing handle. */
+void   termv_reset(Termv *t, unsigned int seed);
+
+/*
+ * Select the rotation system. The current piece returns to its spawn
+ * position, so call this right after create or reset. The choice is kept
+ * across termv_reset().
+ */
+void   termv_set_rotation(Termv *t, TermvRotation rs);
+
+/* Advance by ticks; the same as that many single-tick steps. */
+void   termv_step(Termv *t, unsigned int ticks);
+
+/* Apply one player action. Returns 1 if it changed the game, 0 otherwise. */
+int    termv_apply(Termv *t, TermvAction action);
+
+TermvState termv_state(const Termv *t);
+int    termv_score(const Termv *t);
+int    termv_lines(const Termv *t);
+int    termv_level(const Termv *t);
+
+/* Copy the board (row-major, 0 = empty, 1-7 = color ID) into out. */
+void   termv_board(const Termv *t,
+                   unsigned char out[TERMV_BOARD_HEIGHT * TERMV_BOARD_WIDTH]);
+
+/* Board occupancy as one bitmask per row: bit c set = column c is filled. */
+void   termv_board_bits(const Termv *t, unsigned short out[TERMV_BOARD_HEIGHT]);
+
+/* Current falling piece, and the type of the next one. */
+void   termv_current(const Termv *t, TermvPiece *out);
+int    termv_next(const Termv *t);
+
+void   termv_timers(const Termv *t, TermvTimers *out);
+void   termv_stats(const Termv *t, TermvStats *out);
+
+/*
+ * The n pieces (TermvPieceType) that will follow termv_next(). Queues
+ * longer than 64 pieces are staged on the heap; out is left untouched if
+ * that allocation fails.
+ */
+void   termv_queue(const Termv *t, int *out, size_t n);
+
+/*
+ * Search for a perfect clear using the current piece, the next piece and
+ * the rest of the bag, in order. Writes up to 9 resting placements to out
+ * and returns how many, or 0 if none was found. threads <= 0 uses every CPU.
+ */
+int    termv_find_perfect_clear(const Termv *t, int threads, TermvPiece out[9]);
+
+/*
+ * Pieces start .. start+n-1 dealt for seed, where piece 0 is the first
+ * current piece. Sequences are identical on every platform, and seeking
+ * to any start is O(log start).
+ */
+void   termv_piece_sequence(unsigned int seed, unsigned long long start,
+                            int *out, size_t n);
+
+/*
+ * Serialize the full game state into buf. Returns bytes written, or 0 if
+ * cap is too small. termv_deserialize() replaces t's state; it returns 1 on
+ * success and leaves t untouched on failure.
+ */
+size_t termv_serialize(const Termv *t, unsigned char *buf, size_t cap);
+int    termv_deserialize(Termv *t, const unsigned char *buf, size_t len);
+
+/*
+ * Batch API: K independent games stepped together, stored
+ * structure-of-arrays so gravity and collision checks run across games
+ * with SIMD where the CPU allows it. Rules match the single-game API;
+ * the boards track occupancy only (no colors).
+ */
+typedef struct TermvBatch TermvBatch;
+
+typedef struct {
+    TermvState     state;
+    int            score;
+    int            lines;
+    int            level;
+    int            next;
+    TermvPiece     current;
+    unsigned short rows[TERMV_BOARD_HEIGHT];  /* bit c set = column c filled */
+} TermvLane;
+
+/* Game k is seeded seed + k. */
+TermvBatch *termv_batch_create(unsigned int count, unsigned int seed);
+void        termv_batch_destroy(TermvBatch *b);
+unsigned    termv_batch_count(const TermvBatch *b);
+void        termv_batch_reset(TermvBatch *b, unsigned int lane, unsigned int seed);
+
+/* Rotation system for every game, as termv_set_rotation(). */
+void        termv_batch_set_rotation(TermvBatch *b, TermvRotation rs);
+
+/*
+ * Apply actions[k] to game k (actions may be NULL for none), then advance
+ * every game by ticks milliseconds.
+ */
+void        termv_batch_step(TermvBatch *b, const TermvAction *actions,
+                             unsigned int ticks);
+
+/* Read game lane into out. Returns 0, leaving out untouched, if lane >= count. */
+int         termv_batch_lane(const TermvBatch *b, unsigned int lane, TermvLane *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,15 +1,6 @@
 #include "theme.h"
 #include <ncurses.h>
 
-typedef struct {
-    const char *name;
-    short piece[7];  /* color for pieces 1-7 (I,O,T,S,Z,J,L) */
-    short ghost;
-    short border;
-    short label;
-    short legend;
-} Theme;
-
 static const Theme themes[] = {
     /* PASTEL (current default) */
     {
@@ -69,3 +60,7 @@ void theme_cycle(void) {
 const char *theme_name(void) {
     return themes[current_theme].name;
 }
+
+const Theme *theme_get(unsigned cycles) {
+    return &themes[cycles % THEME_COUNT];
+}
@@ -7,6 +7,16 @@
 #define COLOR_LABEL  10
 #define COLOR_LEGEND 11
 
+/* Colors are curses color numbers, which are also the ANSI color indices */
+typedef struct {
+    const char *name;
+    short piece[7];  /* color for pieces 1-7 (I,O,T,S,Z,J,L) */
+    short ghost;
+    short border;
+    short label;
+    short legend;
+} Theme;
+
 /* Initialize the theme system and apply the default theme. */
 void theme_init(void);
 
@@ -16,4 +26,7 @@ void theme_cycle(void);
 /* Return the name of the current theme. */
 const char *theme_name(void);
 
+/* The theme reached after cycles theme changes from the default, for drawing without color pairs. */
+const Theme *theme_get(unsigned cycles);
+
 #endif
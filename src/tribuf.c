@@ -0,0 +1,45 @@
+#include "tribuf.h"
+#include <stdlib.h>
+
+/* Set on middle when it holds a slot the consumer has not taken */
+#define TRIBUF_FRESH 4u
+
+int tribuf_init(TripleBuffer *tb, size_t size) {
+    for (int i = 0; i < 3; i++) {
+        tb->slots[i] = calloc(1, size);
+        if (!tb->slots[i]) {
+            while (i-- > 0)
+                free(tb->slots[i]);
+            return 0;
+        }
+    }
+    tb->back = 0;
+    tb->middle = 1;
+    tb->front = 2;
+    return 1;
+}
+
+void tribuf_free(TripleBuffer *tb) {
+    for (int i = 0; i < 3; i++) {
+        free(tb->slots[i]);
+        tb->slots[i] = NULL;
+    }
+}
+
+void *tribuf_back(TripleBuffer *tb) {
+    return tb->slots[tb->back];
+}
+
+void tribuf_publish(TripleBuffer *tb) {
+    /* Release orders the slot's contents before the index swap */
+    unsigned old = __atomic_exchange_n(&tb->middle, tb->back | TRIBUF_FRESH, __ATOMIC_ACQ_REL);
+    tb->back = old & ~TRIBUF_FRESH;
+}
+
+const void *tribuf_acquire(TripleBuffer *tb) {
+    if (!(__atomic_load_n(&tb->middle, __ATOMIC_RELAXED) & TRIBUF_FRESH))
+        return NULL;
+    unsigned old = __atomic_exchange_n(&tb->middle, tb->front, __ATOMIC_ACQ_REL);
+    tb->front = old & ~TRIBUF_FRESH;
+    return tb->slots[tb->front];
+}
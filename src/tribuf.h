@@ -0,0 +1,33 @@
+#ifndef TRIBUF_H
+#define TRIBUF_H
+
+#include <stddef.h>
+
+/*
+ * Lock-free triple buffer for one producer and one consumer. The producer
+ * fills the back slot and publishes it; the consumer takes the newest
+ * published slot. Neither side ever waits for the other: a slow consumer
+ * just skips frames, and the producer always has a free slot to write.
+ */
+typedef struct {
+    void    *slots[3];
+    unsigned back;    /* producer's slot */
+    unsigned front;   /* consumer's slot */
+    unsigned middle;  /* last published slot, TRIBUF_FRESH if unread */
+} TripleBuffer;
+
+/* Allocate three zeroed slots of size bytes. Returns 0 on failure. */
+int   tribuf_init(TripleBuffer *tb, size_t size);
+void  tribuf_free(TripleBuffer *tb);
+
+/* Producer: the slot to fill, then hand it over. */
+void *tribuf_back(TripleBuffer *tb);
+void  tribuf_publish(TripleBuffer *tb);
+
+/*
+ * Consumer: the newest published slot, or NULL if nothing was published
+ * since the last call. The slot stays valid until the next call.
+ */
+const void *tribuf_acquire(TripleBuffer *tb);
+
+#endif
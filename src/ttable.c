@@ -0,0 +1,42 @@
+#include "ttable.h"
+#include <stdlib.h>
+
+/* Linear-probe limit before an insert gives up */
+#define TTABLE_MAX_PROBE 64
+
+int ttable_init(TTable *t, int mb) {
+    uint64_t slots = 1;
+    while (slots * 2 * sizeof(uint64_t) <= (uint64_t)(mb > 0 ? mb : 1) << 20)
+        slots *= 2;
+    t->slots = calloc(slots, sizeof(uint64_t));  /* untouched pages stay unbacked */
+    t->mask = slots - 1;
+    t->full = 0;
+    return t->slots != NULL;
+}
+
+void ttable_free(TTable *t) {
+    free(t->slots);
+    t->slots = NULL;
+}
+
+int ttable_insert(TTable *t, uint64_t key) {
+    if (key == 0)
+        key = 1;
+
+    uint64_t i = key & t->mask;
+    for (int probe = 0; probe < TTABLE_MAX_PROBE; probe++, i = (i + 1) & t->mask) {
+        uint64_t v = __atomic_load_n(&t->slots[i], __ATOMIC_ACQUIRE);
+        if (v == key)
+            return 0;
+        if (v == 0) {
+            uint64_t expected = 0;
+            if (__atomic_compare_exchange_n(&t->slots[i], &expected, key, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                return 1;
+            if (expected == key)
+                return 0;
+        }
+    }
+    __atomic_store_n(&t->full, 1, __ATOMIC_RELAXED);
+    return TTABLE_FULL;
+}
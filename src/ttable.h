@@ -0,0 +1,30 @@
+#ifndef TTABLE_H
+#define TTABLE_H
+
+#include <stdint.h>
+
+/*
+ * Transposition table shared by search threads: an open-addressed set of
+ * nonzero 64-bit keys. Slots are claimed with one compare-and-swap from 0,
+ * so inserts need no lock and exactly one inserter wins for each key.
+ */
+
+#define TTABLE_FULL (-1)
+
+typedef struct {
+    uint64_t *slots;
+    uint64_t  mask;
+    int       full;  /* set once any insert ran out of probes */
+} TTable;
+
+/* Allocate the largest power-of-two table that fits in mb megabytes. Returns 0 on failure. */
+int  ttable_init(TTable *t, int mb);
+void ttable_free(TTable *t);
+
+/*
+ * Insert key (0 is remapped). Returns 1 if newly inserted, 0 if already
+ * present, TTABLE_FULL if no free slot was found near its home slot.
+ */
+int  ttable_insert(TTable *t, uint64_t key);
+
+#endif
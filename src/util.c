@@ -0,0 +1,23 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "util.h"
+#include <time.h>
+#include <unistd.h>
+
+double util_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+double util_now_seconds(void) {
+    return util_now_ms() / 1000.0;
+}
+
+int util_thread_count(int requested) {
+    if (requested <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        requested = cpus > 0 ? (int)cpus : 1;
+    }
+    return requested > UTIL_MAX_THREADS ? UTIL_MAX_THREADS : requested;
+}
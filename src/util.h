@@ -0,0 +1,16 @@
+#ifndef UTIL_H
+#define UTIL_H
+
+/* Small system helpers shared by the tools and the frontend. */
+
+/* Most worker threads any parallel tool starts */
+#define UTIL_MAX_THREADS 64
+
+/* Monotonic clock, for measuring intervals. */
+double util_now_ms(void);
+double util_now_seconds(void);
+
+/* Worker threads to use: requested, or one per CPU if <= 0, at most UTIL_MAX_THREADS. */
+int    util_thread_count(int requested);
+
+#endif
@@ -0,0 +1,295 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "watch.h"
+#include "agent.h"
+#include "replay.h"
+#include "render.h"
+#include "input.h"
+#include "game.h"
+#include "layout.h"
+#include "util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define AGENT_CELL_COLOR 8      /* locked cells carry no color in observations */
+#define BUDGET_SMOOTHING 0.25   /* weight of the newest frame in the output average */
+#define MAX_SEGMENTS     RENDER_TILES_MAX
+
+typedef enum {
+    SOURCE_REPLAY,
+    SOURCE_AGENT
+} SourceKind;
+
+typedef struct {
+    SourceKind   kind;
+    char         name[16];
+
+    /* SOURCE_REPLAY: played back against the wall clock */
+    ReplayReader replay;
+    Game         game;
+    double       played_ms;
+    int          ended;
+
+    /* SOURCE_AGENT: one game of a mapped segment */
+    const AgentObservationRing *observations;
+} Source;
+
+typedef struct {
+    void  *base;
+    size_t size;
+} Segment;
+
+/* Last path component, for tile names */
+static const char *base_name(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+/* ── Tile views ──────────────────────────────────────────────────── */
+
+/* Agent observations carry no Game to lay out: the piece is placed here */
+static void place_piece(RenderTile *t, const Piece *p) {
+    int cells[4][2];
+    piece_get_cells(p, cells);
+    for (int i = 0; i < 4; i++) {
+        int vr = cells[i][0] - HIDDEN_HEIGHT;
+        int vc = cells[i][1];
+        if (vr >= 0 && vr < VISIBLE_HEIGHT && vc >= 0 && vc < BOARD_WIDTH)
+            t->cells[vr][vc] = (unsigned char)piece_color(p->type);
+    }
+}
+
+/* Tiles show what the playfield shows, less the ghost */
+static void view_game(RenderTile *t, const Game *g) {
+    LayoutCell cells[VISIBLE_HEIGHT][BOARD_WIDTH];
+    layout_playfield(g, NULL, cells);
+    for (int r = 0; r < VISIBLE_HEIGHT; r++)
+        for (int c = 0; c < BOARD_WIDTH; c++)
+            t->cells[r][c] = cells[r][c].kind == LAYOUT_BLOCK || cells[r][c].kind == LAYOUT_FLASH
+                           ? cells[r][c].color : 0;
+    t->score = g->score;
+    t->lines = g->lines;
+    t->state = g->state;
+}
+
+/*
+ * Copy the newest observation on a ring without consuming it. The slot
+ * is only rewritten after the agent has taken a full ring of newer ones;
+ * returns 0 if that may have happened during the copy.
+ */
+static int peek_observation(const AgentObservationRing *r, AgentObservation *out) {
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    if (head == 0)
+        return 0;
+    memcpy(out, &r->slots[(head - 1) % AGENT_RING_SIZE], sizeof(*out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&r->head, __ATOMIC_RELAXED) - head < AGENT_RING_SIZE - 1;
+}
+
+static void view_observation(RenderTile *t, const AgentObservation *o) {
+    for (int r = 0; r < VISIBLE_HEIGHT; r++) {
+        uint16_t bits = o->rows[HIDDEN_HEIGHT + r];
+        for (int c = 0; c < BOARD_WIDTH; c++)
+            t->cells[r][c] = (bits >> c & 1) ? AGENT_CELL_COLOR : 0;
+    }
+    if (o->state == STATE_RUNNING && o->piece_type < PIECE_COUNT) {
+        /* Agent games always use the basic rotation system */
+        Piece p = { (PieceType)o->piece_type, o->piece_rotation & 3,
+                    o->piece_row, o->piece_col, ROTATION_BASIC };
+        place_piece(t, &p);
+    }
+    t->score = (int)o->score;
+    t->lines = (int)o->lines;
+    t->state = o->state;
+}
+
+/* Bring source s up to the wall clock and describe it in t. */
+static void update_source(Source *s, RenderTile *t, double elapsed_ms) {
+    RenderTile previous = *t;
+
+    memset(t, 0, sizeof(*t));
+    memcpy(t->name, s->name, sizeof(t->name));
+
+    if (s->kind == SOURCE_REPLAY) {
+        while (!s->ended && s->played_ms < elapsed_ms) {
+            unsigned dt = replay_advance(&s->replay, &s->game);
+            if (dt == 0)
+                s->ended = 1;
+            s->played_ms += dt;
+        }
+        view_game(t, &s->game);
+        return;
+    }
+
+    AgentObservation o;
+    if (peek_observation(s->observations, &o))
+        view_observation(t, &o);
+    else
+        *t = previous;  /* nothing published yet, or torn: keep what is shown */
+}
+
+/* ── Sources ─────────────────────────────────────────────────────── */
+
+/* Map an agent segment and add a source per game. Returns 0 on error. */
+static int open_segment(const char *path, int fd, Segment *seg, Source *sources, int *count) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AgentHeader))
+        return 0;
+    seg->size = (size_t)st.st_size;
+    seg->base = mmap(NULL, seg->size, PROT_READ, MAP_SHARED, fd, 0);
+    if (seg->base == MAP_FAILED)
+        return 0;
+
+    const AgentHeader *h = seg->base;
+    if (h->version != AGENT_VERSION || h->games > AGENT_MAX_GAMES
+        || seg->size < agent_segment_size(h->games)) {
+        munmap(seg->base, seg->size);
+        return 0;
+    }
+    for (uint32_t g = 0; g < h->games && *count < RENDER_TILES_MAX; g++) {
+        Source *s = &sources[(*count)++];
+        memset(s, 0, sizeof(*s));
+        s->kind = SOURCE_AGENT;
+        snprintf(s->name, sizeof(s->name), "%.9s#%u", base_name(path), g);
+        s->observations = &agent_channel(seg->base, g)->observations;
+    }
+    return 1;
+}
+
+/* Open every source path, one tile per game in *count. Returns 0 on error. */
+static int open_sources(const WatchOptions *opt, Source *sources, int *count,
+                        Segment *segments, int *segment_count) {
+    for (int i = 0; i < opt->source_count && *count < RENDER_TILES_MAX; i++) {
+        const char *path = opt->sources[i];
+        int fd = open(path, O_RDONLY);
+        uint32_t magic = 0;
+        if (fd < 0 || read(fd, &magic, sizeof(magic)) != (ssize_t)sizeof(magic)) {
+            perror(path);
+            if (fd >= 0)
+                close(fd);
+            return 0;
+        }
+
+        int ok;
+        if (magic == AGENT_MAGIC) {
+            ok = *segment_count < MAX_SEGMENTS
+              && open_segment(path, fd, &segments[*segment_count], sources, count);
+            if (ok)
+                (*segment_count)++;
+        } else {
+            Source *s = &sources[*count];
+            memset(s, 0, sizeof(*s));
+            ok = replay_open(&s->replay, path);
+            if (ok) {
+                s->kind = SOURCE_REPLAY;
+                snprintf(s->name, sizeof(s->name), "%s", base_name(path));
+                replay_start(&s->replay, &s->game);
+                (*count)++;
+            }
+        }
+        close(fd);
+        if (!ok) {
+            fprintf(stderr, "termv: %s is neither a replay nor an agent segment\n", path);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void close_sources(Source *sources, int count, Segment *segments, int segment_count) {
+    for (int i = 0; i < count; i++)
+        if (sources[i].kind == SOURCE_REPLAY)
+            replay_free(&sources[i].replay);
+    for (int i = 0; i < segment_count; i++)
+        munmap(segments[i].base, segments[i].size);
+}
+
+/* ── Viewer loop ─────────────────────────────────────────────────── */
+
+int watch_run(const WatchOptions *opt) {
+    static Source sources[RENDER_TILES_MAX];
+    static RenderTile tiles[RENDER_TILES_MAX], shown[RENDER_TILES_MAX];
+    Segment segments[MAX_SEGMENTS];
+    int segment_count = 0;
+
+    if (opt->source_count == 0) {
+        fprintf(stderr, "termv: --watch needs at least one replay or agent segment\n");
+        return 1;
+    }
+    int count = 0;
+    if (!open_sources(opt, sources, &count, segments, &segment_count)) {
+        close_sources(sources, count, segments, segment_count);
+        return 1;
+    }
+
+    render_init();
+
+    double min_interval = 1000.0 / opt->fps;
+    double budget = opt->budget_kbs * 1024.0 / 1000.0;  /* bytes per ms */
+    double average_bytes = 0.0;
+    double started = util_now_ms(), next_draw = started;
+    double rate_since = started;
+    unsigned redraws = 0, redraws_shown = 0;
+    size_t window_bytes = 0, window_bytes_shown = 0;
+    int have_shown = 0;
+    char status[128];
+
+    for (;;) {
+        InputAction action;
+        int quit = 0;
+        while ((action = input_poll()) != ACTION_NONE)
+            quit |= action == ACTION_QUIT;
+        if (quit)
+            break;
+
+        double now = util_now_ms();
+        for (int i = 0; i < count; i++)
+            update_source(&sources[i], &tiles[i], now - started);
+
+        /* Redraws and output over the last second */
+        if (now - rate_since >= 1000.0) {
+            redraws_shown = redraws;
+            window_bytes_shown = window_bytes;
+            redraws = 0;
+            window_bytes = 0;
+            rate_since = now;
+        }
+        int capacity = render_tiles_capacity();
+        snprintf(status, sizeof(status), "%d games%s | %u redraws/s | ~%zu of %d KB/s | Q:Quit",
+                 count, capacity < count ? " (enlarge the terminal to see all)" : "",
+                 redraws_shown, window_bytes_shown / 1024, opt->budget_kbs);
+
+        size_t bytes = render_draw_tiles(tiles, have_shown ? shown : NULL, count, status);
+        memcpy(shown, tiles, (size_t)count * sizeof(*tiles));
+        have_shown = 1;
+        if (bytes > 0)
+            redraws++;
+        window_bytes += bytes;
+
+        /* Space redraws so the average output fits the budget */
+        average_bytes += BUDGET_SMOOTHING * ((double)bytes - average_bytes);
+        double interval = average_bytes / budget;
+        if (interval < min_interval)
+            interval = min_interval;
+        next_draw += interval;
+        if (next_draw < now)
+            next_draw = now;  /* fell behind: don't burst to catch up */
+
+        double wait = next_draw - util_now_ms();
+        if (wait > 0) {
+            struct timespec ts = { (time_t)(wait / 1000.0),
+                                   (long)((wait - (time_t)(wait / 1000.0) * 1000.0) * 1e6) };
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    render_cleanup();
+    close_sources(sources, count, segments, segment_count);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+/*
+ * Tiled viewer (`termv --watch SOURCE...`): many games at once in one
+ * terminal, each as a compact half-block playfield.
+ *
+ * A source is either a replay file (--record), played back in real time,
+ * or an agent segment (--agent PATH), whose games are shown live from the
+ * newest observation each one published. The segment is mapped read-only
+ * and never consumed from, so the agent driving it is unaffected.
+ *
+ * Tiles are redrawn only when their game changed. Redraws are spaced so
+ * the estimated output stays under a byte budget: a busy grid on a slow
+ * link refreshes less often instead of backing up the terminal.
+ */
+
+typedef struct {
+    char *const *sources;
+    int          source_count;
+    int          fps;          /* most redraws per second */
+    int          budget_kbs;   /* terminal output budget, KB per second */
+} WatchOptions;
+
+#define WATCH_DEFAULT_BUDGET_KBS 128
+
+/* Run until Q is pressed. Returns a process exit status. */
+int watch_run(const WatchOptions *opt);
+
+#endif